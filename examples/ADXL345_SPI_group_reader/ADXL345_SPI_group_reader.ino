@@ -0,0 +1,81 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to read four ADXL345 on one SPI interface with
+* ADXL345_Group. All sensors run with the same data rate and their FIFOs in 
+* stream mode. service() polls the FIFO levels and drains them. readFrame()
+* delivers one sample per sensor, all taken at the same time.
+*   
+* Further information can be found on: 
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+
+#include<SPI.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Group.h>
+const uint8_t numSensors = 4;
+const uint8_t queueDepth = 40;
+const int csPins[numSensors] = {7, 6, 5, 4};
+bool spi = true;    // flag indicating that SPI shall be used
+
+ADXL345_WE myAcc_1 = ADXL345_WE(&SPI, csPins[0], spi);
+ADXL345_WE myAcc_2 = ADXL345_WE(&SPI, csPins[1], spi);
+ADXL345_WE myAcc_3 = ADXL345_WE(&SPI, csPins[2], spi);
+ADXL345_WE myAcc_4 = ADXL345_WE(&SPI, csPins[3], spi);
+ADXL345_WE *accs[numSensors] = {&myAcc_1, &myAcc_2, &myAcc_3, &myAcc_4};
+
+/* If sensors are connected to different interfaces, pass the bus of each sensor as 
+   fifth parameter, e.g. uint8_t busIds[numSensors] = {0, 0, 1, 1}; */
+xyzInt16 queues[numSensors * queueDepth];
+ADXL345_Group myGroup = ADXL345_Group(accs, numSensors, queues, queueDepth);
+
+void setup(){
+  Serial.begin(115200);
+  for(int i=0; i<numSensors; i++){
+    pinMode(csPins[i], OUTPUT);
+    digitalWrite(csPins[i], HIGH);
+  }
+  Serial.println("ADXL345_Sketch - Group Reader");
+  for(int i=0; i<numSensors; i++){
+    if(!accs[i]->init()){
+      Serial.print("ADXL345 ");
+      Serial.print(i + 1);
+      Serial.println(" not connected!");
+    }
+  }
+
+/* Choose the schedule:
+    ADXL345_ROUND_ROBIN     the sensor which is drained first changes with each call
+    ADXL345_FULLEST_FIRST   the sensor with the fullest FIFO is drained first
+*/
+  myGroup.setSchedule(ADXL345_FULLEST_FIRST);
+  myGroup.begin(ADXL345_DATA_RATE_100);
+}
+
+void loop(){
+  myGroup.service();
+
+  xyzInt16 frame[numSensors];
+  while(myGroup.readFrame(frame)){
+    for(int i=0; i<numSensors; i++){
+      xyzFloat g;
+      accs[i]->rawToGValues(&frame[i], &g, 1);
+      Serial.print(g.z);
+      Serial.print(i < numSensors - 1 ? "\t" : "\n");
+    }
+  }
+  
+  static unsigned long lastReport = 0;
+  if(millis() - lastReport > 5000){
+    Serial.print("Configured rate [S/s]: ");
+    Serial.print(myGroup.getConfiguredRate());
+    Serial.print("  |  Achievable rate [S/s]: ");
+    Serial.print(myGroup.getAchievableRate());
+    Serial.print("  |  Full FIFOs: ");
+    Serial.println(myGroup.getFullFifos());
+    lastReport = millis();
+  }
+  delay(50);
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to calibrate the ADXL345 while it is measuring. 
+* ADXL345_AutoCal looks for phases in which the module is at rest and uses
+* them to calculate the offsets and correction factors. Turn the module 
+* slowly into different directions (like in ADXL345_calibration.ino, but in 
+* any order) and hold it still for a second each time. After six or more 
+* positions the calibration is applied. It continues to improve with every 
+* new position.
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_AutoCal.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+ADXL345_AutoCal myCal = ADXL345_AutoCal(&myAcc);
+xyzInt16 fifoBuffer[32];
+unsigned long lastOutput = 0;
+
+void setup(){
+  Wire.begin();
+  Serial.begin(115200);
+  Serial.println("ADXL345_Sketch - Auto Calibration");
+  Serial.println();
+  if(!myAcc.init()){
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_100);
+  myAcc.setRange(ADXL345_RANGE_2G);
+
+/* Samples per stillness check and the max. standard deviation (g) of each axis
+   within these samples. 32 samples and 0.01 g are the defaults. */
+  // myCal.setStillness(32, 0.01);
+  
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  /* In stream mode the FIFO keeps the last 32 values, so reading it every 
+     200 ms (= 20 values at 100 Hz) does not lose any */
+  uint8_t n = myAcc.readFifo(fifoBuffer, 32);
+  if(myCal.addSamples(fifoBuffer, n)){
+    xyzFloat offset, corr;
+    myCal.getCalibration(&offset, &corr);
+    Serial.print("New calibration after ");
+    Serial.print(myCal.getPoseCount());
+    Serial.println(" positions:");
+    Serial.print("Offsets: ");
+    Serial.print(offset.x);
+    Serial.print(" / ");
+    Serial.print(offset.y);
+    Serial.print(" / ");
+    Serial.println(offset.z);
+    Serial.print("Correction factors: ");
+    Serial.print(corr.x, 4);
+    Serial.print(" / ");
+    Serial.print(corr.y, 4);
+    Serial.print(" / ");
+    Serial.println(corr.z, 4);
+  }
+  
+  /* getGValues() would take a value from the FIFO, so the newest FIFO value is converted */
+  if(n > 0 && millis() - lastOutput > 1000){
+    lastOutput = millis();
+    xyzFloat g;
+    myAcc.rawToGValues(&fifoBuffer[n-1], &g, 1);
+    Serial.print(myCal.isCalibrated() ? "calibrated  " : "uncalibrated");
+    Serial.print("  g-x = ");
+    Serial.print(g.x);
+    Serial.print("  |  g-y = ");
+    Serial.print(g.y);
+    Serial.print("  |  g-z = ");
+    Serial.println(g.z);
+  }
+  delay(200);
+}
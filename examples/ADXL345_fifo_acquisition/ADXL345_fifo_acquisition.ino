@@ -0,0 +1,78 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to acquire data continuously with ADXL345_Acquisition.
+* The FIFO runs in stream mode. Each watermark interrupt signals that the FIFO
+* has to be drained. service() moves the data into a ring buffer, from which 
+* loop() takes the samples at its own pace. Nothing is lost if loop() stalls 
+* for a while, as long as the ring buffer does not overflow.
+*   
+* Further information can be found on: 
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Acquisition.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+const int int1Pin = 2;
+const uint16_t ringSize = 128;
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+xyzInt16 ringBuffer[ringSize];
+ADXL345_Acquisition myAcq = ADXL345_Acquisition(&myAcc, ringBuffer, ringSize);
+
+void setup() {
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  pinMode(int1Pin, INPUT);
+  Serial.println("ADXL345_Sketch - FIFO - Continuous Acquisition");
+  Serial.println();
+  if (!myAcc.init()) {
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_100);
+  myAcc.setRange(ADXL345_RANGE_4G);
+
+  attachInterrupt(digitalPinToInterrupt(int1Pin), eventISR, RISING);
+
+/* begin() sets the FIFO into stream mode and enables the watermark interrupt:
+    1. Interrupt pin: INT_PIN_1 or INT_PIN_2
+    2. Watermark (1...32): number of samples in the FIFO which trigger the interrupt
+*/
+  myAcc.readAndClearInterrupts();
+  myAcq.begin(INT_PIN_1, 16);
+}
+
+void loop() {
+  myAcq.service();
+  
+  xyzInt16 raw;
+  while(myAcq.read(&raw)){
+    xyzFloat g;
+    myAcc.rawToGValues(&raw, &g, 1);
+    Serial.print(g.x);
+    Serial.print("\t");
+    Serial.print(g.y);
+    Serial.print("\t");
+    Serial.println(g.z);
+  }
+  
+  static unsigned long lastReport = 0;
+  if(millis() - lastReport > 5000){
+    Serial.print("Acquired: ");
+    Serial.print(myAcq.getSamplesAcquired());
+    Serial.print("  |  Dropped: ");
+    Serial.print(myAcq.getDropped());
+    Serial.print("  |  FIFO overruns: ");
+    Serial.println(myAcq.getOverruns());
+    lastReport = millis();
+  }
+}
+
+void eventISR() {
+  myAcq.onInterrupt();
+}
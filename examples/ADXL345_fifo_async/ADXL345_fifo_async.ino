@@ -0,0 +1,72 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to drain the FIFO without blocking loop() for the
+* whole transfer. ADXL345_Async reads FIFO_STATUS and then one FIFO entry 
+* per poll(). In between, loop() can do other things. The callback is called
+* when the read is complete.
+*   
+* Further information can be found on: 
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Async.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+ADXL345_Async myAsync = ADXL345_Async(&myAcc);
+xyzInt16 fifoBuffer[32];
+unsigned long loopCounter = 0;
+
+void setup() {
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  Serial.println("ADXL345_Sketch - FIFO - Non-blocking Reads");
+  Serial.println();
+  if (!myAcc.init()) {
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_100);
+  myAcc.setRange(ADXL345_RANGE_4G);
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  /* Start a new read if the last one is complete */
+  if(!myAsync.isBusy()){
+    myAsync.startReadFifo(fifoBuffer, 32, fifoComplete, nullptr);
+  }
+  
+  /* poll() returns ADXL345_ASYNC_BUSY, ADXL345_ASYNC_DONE, ADXL345_ASYNC_IDLE 
+     or ADXL345_ASYNC_ERROR */
+  if(myAsync.poll() == ADXL345_ASYNC_ERROR){
+    Serial.println("Read error!");
+  }
+  
+  loopCounter++;  // here is the place for your other tasks
+  delay(5);
+}
+
+void fifoComplete(void *context, uint8_t entries){
+  if(entries == 0){
+    return;
+  }
+  xyzFloat g;
+  myAcc.rawToGValues(&fifoBuffer[entries - 1], &g, 1);
+  Serial.print("Entries: ");
+  Serial.print(entries);
+  Serial.print("  |  Loops meanwhile: ");
+  Serial.print(loopCounter);
+  Serial.print("  |  last g (x,y,z): ");
+  Serial.print(g.x);
+  Serial.print("   ");
+  Serial.print(g.y);
+  Serial.print("   ");
+  Serial.println(g.z);
+  loopCounter = 0;
+}
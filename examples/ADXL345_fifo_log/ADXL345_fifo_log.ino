@@ -0,0 +1,67 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to log the values in the compact binary format of
+* ADXL345_Log.h. The ADXL345 measures at 400 Hz in FIFO stream mode. The 
+* FIFO contents are encoded directly from the read buffer and sent as 
+* binary data via Serial, typically 3 - 5 bytes per sample instead of 
+* 20+ as text. In the same way you can write the bytes to a file on an SD
+* card or to flash, or send them by radio.
+* 
+* Capture the data on the PC, e.g. on Linux (adjust the port):
+*   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin
+* and decode it with extras/benchmark/log_decode.cpp:
+*   ./log_decode capture.bin > capture.csv
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Log.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+ADXL345_LogEncoder logEncoder;
+xyzInt16 fifoBuffer[32];
+uint8_t logBuffer[32 * ADXL345_LogEncoder::ADXL345_LOG_SYNC_BYTES];  // enough for any 32 samples
+unsigned long lastHeader = 0;
+
+void setup(){
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  if(!myAcc.init()){
+    while(1);   // no text output, it would disturb the binary data
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_400);
+  myAcc.setRange(ADXL345_RANGE_4G);
+  myAcc.setFullRes(true);
+
+/* A sync frame with absolute values every 400 samples (1 s). After damaged data the decoder 
+   continues at the next one. */
+  logEncoder.begin(400);
+  writeHeader();
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  /* At 400 Hz the FIFO is full after 80 ms */
+  uint8_t n = myAcc.readFifo(fifoBuffer, 32);
+  size_t len = logEncoder.encode(fifoBuffer, n, logBuffer);
+  Serial.write(logBuffer, len);
+
+  /* Repeat the header from time to time, so that a capture started later can be scaled */
+  if(millis() - lastHeader > 10000){
+    writeHeader();
+  }
+  delay(40);
+}
+
+void writeHeader(){
+  size_t len = logEncoder.writeHeader(&myAcc, logBuffer);
+  Serial.write(logBuffer, len);
+  lastHeader = millis();
+}
@@ -36,6 +36,10 @@ void setup() {
 /* Insert your data from ADXL345_calibration.ino and uncomment for more precise results */
   // myAcc.setCorrFactors(-266.0, 285.0, -268.0, 278.0, -291.0, 214.0);
 
+/* Uncomment to let the ADXL345 subtract the offsets itself (OFSX, OFSY, OFSZ registers, 
+   15.6 mg steps). The FIFO values are then already corrected. */
+  // myAcc.enableHardwareOffsets();
+
 /* Choose the data rate         Hz
     ADXL345_DATA_RATE_3200    3200
     ADXL345_DATA_RATE_1600    1600
@@ -161,10 +165,14 @@ void eventISR() {
   event = true;
 }
 
+/* readFifo() reads all FIFO entries with a minimum of bus overhead. The raw values are 
+   converted with rawToGValues(), which can also convert complete arrays. */
 void printFifo(){
-  for(int i=0; i<32; i++){
+  xyzInt16 raw[32];
+  uint8_t samples = myAcc.readFifo(raw, 32);
+  for(int i=0; i<samples; i++){
     xyzFloat g;
-    myAcc.getGValues(&g);
+    myAcc.rawToGValues(&raw[i], &g, 1);
     
     Serial.print("g-x   = ");
     Serial.print(g.x);
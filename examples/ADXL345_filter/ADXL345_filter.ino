@@ -0,0 +1,79 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to filter the values from the FIFO with 
+* ADXL345_Filter. The ADXL345 measures at 800 Hz. A 4th order low pass 
+* (40 Hz) suppresses frequencies which a 100 Hz stream cannot represent and
+* only every 8th value is kept, so the sketch gets a smooth 100 Hz stream. 
+* A second stage (high pass 1 Hz) removes gravity from this stream, which 
+* leaves the vibrations.
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Filter.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+ADXL345_Filter lowPass;
+ADXL345_Filter highPass;
+xyzInt16 fifoBuffer[32];
+xyzInt16 smooth[32];
+xyzInt16 vibration[32];
+unsigned int outputCounter = 0;
+
+void setup(){
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  Serial.println("ADXL345_Sketch - Filter");
+  Serial.println();
+  if(!myAcc.init()){
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_800);
+  myAcc.setRange(ADXL345_RANGE_4G);
+
+/* Choose the type (ADXL345_LOW_PASS, ADXL345_HIGH_PASS or ADXL345_FILTER_NONE),
+   the cutoff frequency, the sample rate and the order (2 or 4) */
+  lowPass.begin(ADXL345_LOW_PASS, 40.0, 800.0, 4);
+  lowPass.setDecimation(8);
+  highPass.begin(ADXL345_HIGH_PASS, 1.0, lowPass.getOutputRate(), 2);
+
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  /* At 800 Hz the FIFO is full after 40 ms, so read it at least every 30 ms */
+  uint8_t n = myAcc.readFifo(fifoBuffer, 32);
+  uint16_t m = lowPass.process(fifoBuffer, smooth, n);
+  highPass.process(smooth, vibration, m);
+  
+  for(uint16_t i=0; i<m; i++){
+    if(++outputCounter < 50){ // print every 50th value (2 per second)
+      continue;
+    }
+    outputCounter = 0;
+    xyzFloat g;
+    myAcc.rawToGValues(&smooth[i], &g, 1);
+    /* The high pass output has no offset, it just has to be multiplied with the LSB value */
+    float gPerLsb = ADXL345_WE::MILLI_G_PER_LSB / 1000.0 * myAcc.getRangeFactor();
+    Serial.print("smooth [g]: ");
+    Serial.print(g.x);
+    Serial.print(" / ");
+    Serial.print(g.y);
+    Serial.print(" / ");
+    Serial.print(g.z);
+    Serial.print("   vibration [g]: ");
+    Serial.print(vibration[i].x * gPerLsb);
+    Serial.print(" / ");
+    Serial.print(vibration[i].y * gPerLsb);
+    Serial.print(" / ");
+    Serial.println(vibration[i].z * gPerLsb);
+  }
+  delay(20);
+}
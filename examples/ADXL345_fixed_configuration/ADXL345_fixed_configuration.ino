@@ -0,0 +1,65 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to use ADXL345_Fixed if bus, range and resolution 
+* are fixed in your application. These settings are template parameters, 
+* so the compiler can resolve the bus accesses and the scale factors. The 
+* result is less code and faster conversions. ADXL345_Fixed only offers the
+* data path (raw / g / milli-g values, FIFO), for everything else use 
+* ADXL345_WE.
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+
+#include<SPI.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Fixed.h>
+#define CS_PIN 10   // Chip Select Pin
+
+/* For I2C use: 
+   ADXL345_I2CBus myBus(&Wire, 0x53);
+   ADXL345_Fixed<ADXL345_I2CBus, ADXL345_RANGE_4G, true> myAcc(myBus); */
+ADXL345_SPIBus myBus(&SPI, CS_PIN);
+
+/* Template parameters: 
+    1. Bus type:   ADXL345_SPIBus or ADXL345_I2CBus
+    2. Range:      ADXL345_RANGE_2G, ADXL345_RANGE_4G, ADXL345_RANGE_8G or ADXL345_RANGE_16G
+    3. Resolution: true = full resolution, false = 10 bit 
+*/
+ADXL345_Fixed<ADXL345_SPIBus, ADXL345_RANGE_16G, true> myAcc(myBus);
+
+void setup(){
+  Serial.begin(115200);
+  Serial.println("ADXL345_Sketch - Fixed Configuration");
+  Serial.println();
+  if(!myAcc.init(ADXL345_DATA_RATE_100)){
+    Serial.println("ADXL345 not connected!");
+  }
+}
+
+void loop(){
+  xyzInt16 raw;
+  xyzInt16 mg;
+  myAcc.getRawValues(&raw);
+  mg = myAcc.rawToMilliG(raw);
+  
+  Serial.print("Raw-x = ");
+  Serial.print(raw.x);
+  Serial.print("  |  Raw-y = ");
+  Serial.print(raw.y);
+  Serial.print("  |  Raw-z = ");
+  Serial.println(raw.z);
+
+  Serial.print("x [mg] = ");
+  Serial.print(mg.x);
+  Serial.print("  |  y [mg] = ");
+  Serial.print(mg.y);
+  Serial.print("  |  z [mg] = ");
+  Serial.println(mg.z);
+
+  Serial.println();
+  delay(1000);
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to handle several interrupts with ADXL345_Dispatcher.
+* The FIFO runs in stream mode with the watermark interrupt, in addition
+* single taps trigger an interrupt. Both are mapped to INT1. The ISR only 
+* calls onInterrupt(). In loop(), service() reads ACT_TAP_STATUS and 
+* INT_SOURCE in one transaction (and FIFO_STATUS if the watermark is 
+* reached) and calls the handler of each interrupt which occurred. Overrun
+* and watermark come first, so the FIFO is drained before anything else.
+*   
+* Further information can be found on: 
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Dispatcher.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+const int int1Pin = 2;
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+ADXL345_Dispatcher dispatcher = ADXL345_Dispatcher(&myAcc);
+xyzInt16 fifoBuffer[32];
+unsigned long samplesReceived = 0;
+
+void onOverrun(void *context, const adxl345_intEvent &event){
+  (void)context;
+  (void)event;
+  Serial.println("FIFO overrun - samples lost!");
+}
+
+void onWatermark(void *context, const adxl345_intEvent &event){
+  (void)context;
+  /* FIFO_STATUS is part of the event, so drainFifo() does not need to read it again */
+  uint8_t n = myAcc.drainFifo(fifoBuffer, event.fifoStatus & ADXL345_WE::ADXL345_FIFO_ENTRIES);
+  samplesReceived += n;
+}
+
+void onTap(void *context, const adxl345_intEvent &event){
+  (void)context;
+  char axes[ADXL345_WE::ADXL345_ACT_TAP_STR_SIZE];
+  ADXL345_WE::actTapStatusToString(event.actTapStatus, axes, sizeof(axes));
+  Serial.print("Tap! Axes: ");
+  Serial.print(axes);
+  Serial.print("  Latency [us]: ");
+  Serial.println(micros() - event.irqMicros);
+}
+
+void setup() {
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  pinMode(int1Pin, INPUT);
+  Serial.println("ADXL345_Sketch - Interrupt Dispatcher");
+  Serial.println();
+  if (!myAcc.init()) {
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_100);
+  myAcc.setRange(ADXL345_RANGE_4G);
+  myAcc.setGeneralTapParameters(ADXL345_XYZ, 3.0, 30, 100.0);
+
+  dispatcher.setHandler(ADXL345_OVERRUN, onOverrun);
+  dispatcher.setHandler(ADXL345_WATERMARK, onWatermark);
+  dispatcher.setHandler(ADXL345_SINGLE_TAP, onTap);
+
+  attachInterrupt(digitalPinToInterrupt(int1Pin), eventISR, RISING);
+  myAcc.setInterrupt(ADXL345_SINGLE_TAP, INT_PIN_1);
+  myAcc.setFifoParameters(ADXL345_TRIGGER_INT_1, 16);
+  myAcc.setInterrupt(ADXL345_WATERMARK, INT_PIN_1);
+  myAcc.setInterrupt(ADXL345_OVERRUN, INT_PIN_1);
+  myAcc.setFifoMode(ADXL345_STREAM);
+  dispatcher.service(true);   // in case INT1 became active before attachInterrupt()
+}
+
+void loop() {
+  dispatcher.service();
+  
+  static unsigned long lastReport = 0;
+  if(millis() - lastReport > 5000){
+    Serial.print("Samples: ");
+    Serial.print(samplesReceived);
+    Serial.print("  |  Max. latency [us]: ");
+    Serial.println(dispatcher.getMaxLatency());
+    lastReport = millis();
+  }
+}
+
+void eventISR() {
+  dispatcher.onInterrupt();
+}
@@ -86,10 +86,14 @@ void setup(){
 }
 
 void loop() {
-  //xyzFloat g;
-  //myAcc.getGValues(&g);
-  xyzFloat corrAngles;
-  myAcc.getCorrAngles(&corrAngles);
+/* getSnapshot() reads the g values once. Angles, pitch and roll are calculated from 
+    this one sample without further bus access. Alternatively you can use getCorrAngles(),
+    getPitch() and getRoll(), but then each function reads its own sample.
+*/
+  ADXL345_Snapshot snap;
+  myAcc.getSnapshot(&snap);
+  //xyzFloat g = snap.getGValues();
+  xyzFloat corrAngles = snap.getCorrAngles();
   
 /* Corrected angles use corrected raws and an extra angle
     offset. The method provides quite precise values for x/y 
@@ -105,8 +109,8 @@ void loop() {
 /* Pitch and roll use corrected slope, but no additional offset. 
     All axes are considered for calculation. 
 */
-  float pitch = myAcc.getPitch();
-  float roll  = myAcc.getRoll();
+  float pitch = snap.getPitch();
+  float roll  = snap.getRoll();
   
   Serial.print("Pitch   = "); 
   Serial.print(pitch); 
@@ -0,0 +1,57 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to record the bus traffic with ADXL345_RecordBus.
+* The recorder sits between the driver and the I2C transport, passes all
+* accesses on and sends each one with a time stamp as binary data via 
+* Serial. In the same way you can write the recording to an SD card. 
+* 
+* On a PC, ADXL345_ReplayBus plays the recording back to the driver, so you
+* can test and benchmark changes of your code with exactly the same data,
+* without the sensor. Capture the data, e.g. on Linux (adjust the port):
+*   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.axr
+* and replay it with extras/benchmark/replay_dump.cpp:
+*   ./replay_dump capture.axr > samples.csv
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Record.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+
+void sendRecord(void *context, const uint8_t *data, size_t len){
+  (void)context;
+  Serial.write(data, len);
+}
+
+ADXL345_I2CBus i2cBus(&Wire, ADXL345_I2CADDR);
+/* ADXL345_RECORD_ALL: all accesses, ADXL345_RECORD_DATA: only data and status reads */
+ADXL345_RecordBus recorder(&i2cBus, sendRecord, nullptr, ADXL345_RECORD_ALL);
+ADXL345_WE myAcc = ADXL345_WE(&recorder);
+xyzInt16 fifoBuffer[32];
+
+void setup(){
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  if(!myAcc.init()){
+    while(1);   // no text output, it would disturb the binary data
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_100);
+  myAcc.setRange(ADXL345_RANGE_4G);
+  myAcc.setInterrupt(ADXL345_SINGLE_TAP, INT_PIN_1);
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  uint8_t intSource = myAcc.readAndClearInterrupts();
+  if(myAcc.checkInterrupt(intSource, ADXL345_SINGLE_TAP)){
+    myAcc.getActTapStatus();
+  }
+  myAcc.readFifo(fifoBuffer, 32);
+  delay(100);
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+* Example sketch for the ADXL345_WE / ADXL343_WE library
+*
+* This sketch shows how to analyze vibrations with ADXL345_Vibration. The 
+* ADXL345 measures at 1600 Hz, the values are read from the FIFO and passed
+* on in blocks. For each window of 256 values (0.16 s) the sketch prints
+* RMS, peak and crest factor of all axes and the dominant frequency and the 
+* band energies of the z-axis spectrum. 
+* 
+* The FFT needs a float buffer of the window size (256 x 4 bytes). On an 
+* AVR based board with 2 KB SRAM, like the UNO, choose a window of 128. 
+* With more memory, a larger window gives a finer frequency resolution
+* (sample rate / window size).
+*  
+* Further information can be found on:
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+* 
+***************************************************************************/
+#include<Wire.h>
+#include<ADXL345_WE.h>
+#include<ADXL345_Vibration.h>
+#define ADXL345_I2CADDR 0x53  // 0x1D if SDO = HIGH
+#define WINDOW_SIZE 256       // power of 2, 16 ... 4096
+
+ADXL345_WE myAcc = ADXL345_WE(ADXL345_I2CADDR);
+float fftBuffer[WINDOW_SIZE];
+ADXL345_Vibration vibration(&myAcc, fftBuffer, WINDOW_SIZE);
+xyzInt16 fifoBuffer[32];
+
+void setup(){
+  Wire.begin();
+  Wire.setClock(400000);
+  Serial.begin(115200);
+  Serial.println("ADXL345_Sketch - Vibration");
+  Serial.println();
+  if(!myAcc.init()){
+    Serial.println("ADXL345 not connected!");
+  }
+  myAcc.setDataRate(ADXL345_DATA_RATE_1600);
+  myAcc.setRange(ADXL345_RANGE_8G);
+  myAcc.setFullRes(true);
+
+/* Choose the sample rate and the axis for the spectrum (ADXL345_VIB_X, ADXL345_VIB_Y,
+   ADXL345_VIB_Z or ADXL345_VIB_MAGNITUDE) */
+  vibration.begin(1600.0, ADXL345_VIB_Z);
+  
+/* Optional: your own frequency bands (default: 8 bands of equal width up to 800 Hz) */
+  // const float edges[5] = {0.0, 50.0, 200.0, 500.0, 801.0};
+  // vibration.setBands(edges, 4);
+  
+  vibration.setCallback(printFeatures);
+  myAcc.setFifoMode(ADXL345_STREAM);
+}
+
+void loop() {
+  /* At 1600 Hz the FIFO is full after 20 ms, so read it at least every 15 ms */
+  uint8_t n = myAcc.readFifo(fifoBuffer, 32);
+  vibration.addSamples(fifoBuffer, n);  // calls printFeatures() after each window
+  delay(5);
+}
+
+void printFeatures(void *context, const adxl345_vibFeatures &features){
+  (void)context;
+  if(features.window % 10 != 0){  // print every 10th window
+    return;
+  }
+  printXYZ("RMS [g]:   ", features.rms);
+  printXYZ("Peak [g]:  ", features.peak);
+  printXYZ("Crest:     ", features.crest);
+  Serial.print("Dominant:  ");
+  Serial.print(features.dominantHz);
+  Serial.print(" Hz, ");
+  Serial.print(features.dominantAmp, 3);
+  Serial.println(" g");
+  Serial.print("Bands [g]: ");
+  for(uint8_t i=0; i<features.bands; i++){
+    Serial.print(features.bandRms[i], 3);
+    Serial.print(" ");
+  }
+  Serial.println();
+  Serial.println();
+}
+
+void printXYZ(const char *label, const xyzFloat &val){
+  Serial.print(label);
+  Serial.print(val.x, 3);
+  Serial.print(" / ");
+  Serial.print(val.y, 3);
+  Serial.print(" / ");
+  Serial.println(val.z, 3);
+}
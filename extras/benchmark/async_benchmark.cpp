@@ -0,0 +1,60 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_Async on the simulated transport. Compares a
+ * blocking FIFO drain followed by computation with a non-blocking drain that
+ * overlaps the computation. All times are simulated bus time.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Async.h"
+
+static constexpr float US_PER_BYTE   {22.5};  // I2C with 400 kHz
+static constexpr uint32_t COMPUTE_US {25};    // one slice of application work
+static constexpr int COMPUTE_SLICES  {200};
+
+static void fillFifo(ADXL345_SimBus &sim, ADXL345_WE &acc){
+    acc.setFifoMode(ADXL345_BYPASS);
+    acc.setFifoMode(ADXL345_STREAM);
+    sim.generateSamples(32);
+    sim.resetCounters();
+}
+
+int main(){
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    xyzInt16 buf[32];
+
+    fillFifo(sim, acc);
+    uint8_t n = acc.readFifo(buf, 32);
+    float blockingUs = sim.getBytes() * US_PER_BYTE + COMPUTE_SLICES * COMPUTE_US;
+
+    fillFifo(sim, acc);
+    sim.setTransferTime(US_PER_BYTE);
+    ADXL345_Async async(&acc);
+    async.startReadFifo(buf, 32);
+    uint32_t asyncUs = 0;
+    int slices = 0;
+    while(async.isBusy() || slices < COMPUTE_SLICES){
+        async.poll();
+        if(slices < COMPUTE_SLICES){
+            slices++;
+        }
+        sim.advanceMicros(COMPUTE_US);
+        asyncUs += COMPUTE_US;
+    }
+
+    printf("mode,entries,bus_bytes,total_us\n");
+    printf("blocking,%u,%u,%.0f\n", n, (unsigned)((blockingUs - COMPUTE_SLICES * COMPUTE_US) / US_PER_BYTE), 
+           blockingUs);
+    printf("async,%u,%u,%u\n", async.getCount(), (unsigned)sim.getBytes(), (unsigned)asyncUs);
+    return 0;
+}
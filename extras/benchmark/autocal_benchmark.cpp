@@ -0,0 +1,129 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_AutoCal. The simulated sensor gets an offset
+ * and gain error and is turned through a sequence of poses with moves in
+ * between, while the FIFO is drained and fed to the calibration. This runs
+ * once with the offsets corrected by the library and once in OFSX-Z
+ * (enableHardwareOffsets()). Reports after how many samples the first
+ * calibration was applied and the max. error of getGValues() over the six
+ * axis directions before and after. Returns 1 if the error after the
+ * calibration is 20 mg or more.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_AutoCal.h"
+
+static constexpr uint16_t HOLD_SAMPLES {200};
+static constexpr uint16_t MOVE_SAMPLES {50};
+static constexpr float NOISE_G         {0.004};   // peak
+static constexpr float MAX_ERR_AFTER   {0.02};    // g
+
+struct Motion
+{
+    const xyzFloat *poses;
+    uint8_t poseCount;
+    uint32_t sample;
+    uint32_t seed;
+};
+
+static xyzFloat normalized(const xyzFloat &v){
+    float n = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return v / n;
+}
+
+static float noise(Motion *m){
+    m->seed = m->seed * 1103515245UL + 12345UL;
+    return ((m->seed >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+}
+
+static bool nextSample(void *context, xyzFloat *gVal){
+    Motion *m = static_cast<Motion *>(context);
+    const uint32_t step = HOLD_SAMPLES + MOVE_SAMPLES;
+    uint8_t pose = (m->sample / step) % m->poseCount;
+    uint32_t t = m->sample % step;
+    xyzFloat g = m->poses[pose];
+    if(t >= HOLD_SAMPLES){
+        float f = static_cast<float>(t - HOLD_SAMPLES) / MOVE_SAMPLES;
+        g = normalized(g * (1.0f - f) + m->poses[(pose + 1) % m->poseCount] * f);
+    }
+    *gVal = g + xyzFloat(noise(m), noise(m), noise(m)) * NOISE_G;
+    m->sample++;
+    return true;
+}
+
+static float maxError(ADXL345_SimBus &sim, ADXL345_WE &acc){
+    const xyzFloat axes[6] = {xyzFloat(1, 0, 0), xyzFloat(-1, 0, 0), xyzFloat(0, 1, 0),
+                              xyzFloat(0, -1, 0), xyzFloat(0, 0, 1), xyzFloat(0, 0, -1)};
+    float err = 0.0;
+    sim.setSampleSource(nullptr, nullptr);
+    acc.setFifoMode(ADXL345_BYPASS);
+    for(int i=0; i<6; i++){
+        sim.setAcceleration(axes[i]);
+        sim.generateSamples(1);
+        xyzFloat g;
+        acc.getGValues(&g);
+        xyzFloat d = g - axes[i];
+        err = fmax(err, fmax(fabs(d.x), fmax(fabs(d.y), fabs(d.z))));
+    }
+    return err;
+}
+
+/* Runs the calibration over three rounds of poses, with the offsets corrected by the library
+   or in OFSX-Z. Returns the max. error after the calibration in g. */
+static float runCalibration(bool hwOffsets, const xyzFloat *poses){
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setRange(ADXL345_RANGE_4G);
+    acc.enableHardwareOffsets(hwOffsets);
+    sim.setSensorError(xyzFloat(0.03, -0.05, 0.08), xyzFloat(1.02, 0.97, 1.04));
+    float before = maxError(sim, acc);
+
+    Motion motion = {poses, 8, 0, 1};
+    ADXL345_AutoCal cal(&acc);
+    sim.setSampleSource(nextSample, &motion);
+    acc.setFifoMode(ADXL345_STREAM);
+    xyzInt16 buf[32];
+    uint32_t firstUpdate = 0;
+    while(motion.sample < 3UL * 8 * (HOLD_SAMPLES + MOVE_SAMPLES)){
+        sim.generateSamples(32);
+        uint8_t n = acc.readFifo(buf, 32);
+        if(cal.addSamples(buf, n) && firstUpdate == 0){
+            firstUpdate = motion.sample;
+        }
+    }
+    float after = maxError(sim, acc);
+
+    xyzFloat offset, corr;
+    acc.getCalibration(&offset, &corr);
+    xyzInt16 hw = acc.getHardwareOffsets();
+    printf("%s,%u,%u,%u,%u,%u,%.1f,%.1f,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%d,%d,%d\n", hwOffsets ? "hardware" : "software",
+           (unsigned)motion.sample, cal.getPoseCount(), cal.getUpdateCount(), cal.getRejectedFits(),
+           (unsigned)firstUpdate, before * 1000.0, after * 1000.0, offset.x, offset.y, offset.z,
+           corr.x, corr.y, corr.z, hw.x, hw.y, hw.z);
+    return after;
+}
+
+int main(){
+    const xyzFloat poses[8] = {
+        xyzFloat(0, 0, 1), normalized(xyzFloat(1, 0.2, 0.1)), normalized(xyzFloat(0.1, 1, -0.2)),
+        normalized(xyzFloat(-1, 0.1, 0.3)), normalized(xyzFloat(0.2, -1, 0.1)), xyzFloat(0, 0, -1),
+        normalized(xyzFloat(0.5, 0.5, 0.7)), normalized(xyzFloat(-0.6, -0.4, -0.7))};
+    printf("offsets,samples,poses,updates,rejected,first_update_sample,max_err_before_mg,max_err_after_mg,"
+           "offset_x,offset_y,offset_z,corr_x,corr_y,corr_z,ofsx,ofsy,ofsz\n");
+    bool ok = true;
+    for(int hw=0; hw<2; hw++){
+        ok &= (runCalibration(hw, poses) < MAX_ERR_AFTER);
+    }
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
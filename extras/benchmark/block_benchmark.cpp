@@ -0,0 +1,92 @@
+/******************************************************************************
+ *
+ * Host benchmark for the block kernels in ADXL345_Block.h. First it checks
+ * that the SIMD kernels deliver exactly the same bits as the scalar
+ * reference for block sizes 0 to 67 (all tails) and for extreme raw values.
+ * Then it reports the time per sample of both. Returns 1 if a result
+ * differs.
+ *
+ * Build with CMakeLists.txt in this directory. Configure with
+ * -DADXL345_BENCH_AVX2=ON to test an AVX2 build, in which the compiler
+ * vectorizes the scalar loops with AVX2.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "ADXL345_Block.h"
+
+static constexpr uint16_t BLOCK_SIZE {1024};
+static constexpr int REPEATS         {2000};
+
+static xyzInt16 raw[BLOCK_SIZE];
+static xyzFloat aosSimd[BLOCK_SIZE], aosScalar[BLOCK_SIZE];
+static float soaSimd[3][BLOCK_SIZE], soaScalar[3][BLOCK_SIZE];
+static float angleIn[BLOCK_SIZE], angleSimd[BLOCK_SIZE], angleScalar[BLOCK_SIZE];
+static volatile float sink;
+
+static bool check(const xyzFloat &offset, const xyzFloat &factor, uint16_t n){
+    adxl345_rawToG(raw, offset, factor, aosSimd, n);
+    adxl345_rawToGScalar(raw, offset, factor, aosScalar, n);
+    adxl345_rawToGSoA(raw, offset, factor, soaSimd[0], soaSimd[1], soaSimd[2], n);
+    adxl345_rawToGSoAScalar(raw, offset, factor, soaScalar[0], soaScalar[1], soaScalar[2], n);
+    adxl345_asinDegBlock(angleIn, angleSimd, n);
+    adxl345_asinDegBlockScalar(angleIn, angleScalar, n);
+    bool ok = memcmp(aosSimd, aosScalar, n * sizeof(xyzFloat)) == 0;
+    for(int axis=0; axis<3; axis++){
+        ok = ok && memcmp(soaSimd[axis], soaScalar[axis], n * sizeof(float)) == 0;
+    }
+    return ok && memcmp(angleSimd, angleScalar, n * sizeof(float)) == 0;
+}
+
+template <typename Func>
+static double nsPerSample(Func func){
+    func();     // warm up
+    auto start = std::chrono::steady_clock::now();
+    for(int r=0; r<REPEATS; r++){
+        func();
+        sink = angleSimd[r % BLOCK_SIZE] + aosSimd[r % BLOCK_SIZE].x + soaSimd[0][r % BLOCK_SIZE];
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (REPEATS * BLOCK_SIZE);
+}
+
+int main(){
+    srand(1);
+    for(uint16_t i=0; i<BLOCK_SIZE; i++){
+        raw[i] = xyzInt16(rand() % 8192 - 4096, rand() % 8192 - 4096, rand() % 8192 - 4096);
+        angleIn[i] = (rand() % 24001 - 12000) / 10000.0f;   // includes |g| > 1
+    }
+    raw[0] = xyzInt16(INT16_MIN, INT16_MAX, 0);
+    angleIn[0] = -0.0f;
+    angleIn[1] = 1.0f;
+    angleIn[2] = -1.0f;
+    const xyzFloat offset(3.25, -12.0625, 20.4), factor(0.0039 * 0.98, 0.0039 * 1.031, 0.0078 * 0.961);
+
+    bool ok = true;
+    for(uint16_t n=0; n<68; n++){
+        ok = ok && check(offset, factor, n);
+    }
+    ok = ok && check(offset, factor, BLOCK_SIZE);
+    ok = ok && check(xyzFloat(0, 0, 0), xyzFloat(1, 1, 1), BLOCK_SIZE);
+
+    printf("simd,%s\nbit_exact,%s\n", adxl345_blockSimd(), ok ? "yes" : "NO");
+    printf("kernel,simd_ns_per_sample,scalar_ns_per_sample\n");
+    printf("rawToG,%.3f,%.3f\n",
+           nsPerSample([&](){ adxl345_rawToG(raw, offset, factor, aosSimd, BLOCK_SIZE); }),
+           nsPerSample([&](){ adxl345_rawToGScalar(raw, offset, factor, aosSimd, BLOCK_SIZE); }));
+    printf("rawToGSoA,%.3f,%.3f\n",
+           nsPerSample([&](){ adxl345_rawToGSoA(raw, offset, factor, soaSimd[0], soaSimd[1], soaSimd[2], BLOCK_SIZE); }),
+           nsPerSample([&](){ adxl345_rawToGSoAScalar(raw, offset, factor, soaSimd[0], soaSimd[1], soaSimd[2],
+                                                       BLOCK_SIZE); }));
+    printf("asinDegBlock,%.3f,%.3f\n",
+           nsPerSample([&](){ adxl345_asinDegBlock(angleIn, angleSimd, BLOCK_SIZE); }),
+           nsPerSample([&](){ adxl345_asinDegBlockScalar(angleIn, angleSimd, BLOCK_SIZE); }));
+    return ok ? 0 : 1;
+}
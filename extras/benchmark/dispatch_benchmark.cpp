@@ -0,0 +1,200 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_Dispatcher on the simulated transport. The
+ * FIFO runs in stream mode with the watermark interrupt on INT2, single
+ * tap and activity interrupts on INT1 occur in between. The same sequence
+ * is handled twice: by hand (readAndClearInterrupts(), getActTapStatus(),
+ * readFifo()) and with the dispatcher. Reports the bus transactions and
+ * bytes for the status registers per interrupt (without the FIFO data) and
+ * checks that both deliver the same samples and events and that the
+ * handlers are called in priority order. Finally it checks that an
+ * interrupt is not lost if the status read fails. Returns 1 if a check
+ * fails.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Dispatcher.h"
+
+static constexpr uint16_t ROUNDS {20000};
+
+struct Result
+{
+    ADXL345_WE *acc;
+    std::vector<xyzInt16> samples;
+    std::vector<uint8_t> taps;
+    uint32_t activities;
+    uint32_t interrupts;
+    uint32_t statusTransactions;
+    uint32_t statusBytes;
+    int lastRank;
+    uint32_t orderErrors;
+    double ns;
+};
+
+static int rank(adxl345_int type){
+    static const adxl345_int order[8] = {ADXL345_OVERRUN, ADXL345_WATERMARK, ADXL345_DATA_READY,
+        ADXL345_FREEFALL, ADXL345_SINGLE_TAP, ADXL345_DOUBLE_TAP, ADXL345_ACTIVITY, ADXL345_INACTIVITY};
+    for(int i=0; i<8; i++){
+        if(order[i] == type){
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void checkOrder(Result *r, adxl345_int type){
+    if(rank(type) < r->lastRank){
+        r->orderErrors++;
+    }
+    r->lastRank = rank(type);
+}
+
+static void onWatermark(void *context, const adxl345_intEvent &event){
+    Result *r = static_cast<Result *>(context);
+    checkOrder(r, event.type);
+    xyzInt16 buf[32];
+    /* FIFO_STATUS came with the event, no need to read it again */
+    uint8_t n = r->acc->drainFifo(buf, event.fifoStatus & ADXL345_WE::ADXL345_FIFO_ENTRIES);
+    r->samples.insert(r->samples.end(), buf, buf + n);
+}
+
+static void onTap(void *context, const adxl345_intEvent &event){
+    Result *r = static_cast<Result *>(context);
+    checkOrder(r, event.type);
+    r->taps.push_back(event.actTapStatus);
+}
+
+static void onActivity(void *context, const adxl345_intEvent &event){
+    Result *r = static_cast<Result *>(context);
+    checkOrder(r, event.type);
+    r->activities++;
+}
+
+/* Fails the next read, like a NACK on I2C */
+class FailingSimBus : public ADXL345_SimBus
+{
+    public:
+        bool failNext = false;
+
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override {
+            if(failNext){
+                failNext = false;
+                return false;
+            }
+            return ADXL345_SimBus::readRegisters(reg, buf, count);
+        }
+};
+
+/* The interrupt stays pending after a failed status read, so the next service() handles it */
+static bool retryAfterReadError(){
+    FailingSimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setInterrupt(ADXL345_SINGLE_TAP, INT_PIN_1);
+    Result r = {&acc, {}, {}, 0, 0, 0, 0, 0, 0, 0.0};
+    ADXL345_Dispatcher dispatcher(&acc);
+    dispatcher.setHandler(ADXL345_SINGLE_TAP, onTap, &r);
+    sim.triggerEvent(ADXL345_SINGLE_TAP, 1);
+    dispatcher.onInterrupt();
+    sim.failNext = true;
+    uint8_t failed = dispatcher.service();
+    uint8_t retried = dispatcher.service();
+    return failed == 0 && retried == 1 && r.taps.size() == 1;
+}
+
+static Result run(bool useDispatcher){
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setDataRate(ADXL345_DATA_RATE_800);
+    acc.setInterrupt(ADXL345_SINGLE_TAP, INT_PIN_1);
+    acc.setInterrupt(ADXL345_ACTIVITY, INT_PIN_1);
+    acc.setFifoParameters(ADXL345_TRIGGER_INT_1, 16);
+    acc.setInterrupt(ADXL345_WATERMARK, INT_PIN_2);
+    acc.setFifoMode(ADXL345_STREAM);
+
+    Result r = {&acc, {}, {}, 0, 0, 0, 0, 0, 0, 0.0};
+    ADXL345_Dispatcher dispatcher(&acc);
+    dispatcher.setHandler(ADXL345_WATERMARK, onWatermark, &r);
+    dispatcher.setHandler(ADXL345_SINGLE_TAP, onTap, &r);
+    dispatcher.setHandler(ADXL345_ACTIVITY, onActivity, &r);
+    srand(11);
+    for(uint16_t round=0; round<ROUNDS; round++){
+        sim.generateSamples(1 + rand() % 6);
+        if(rand() % 40 == 0){
+            sim.triggerEvent(ADXL345_SINGLE_TAP, 1 << (rand() % 3));
+        }
+        if(rand() % 60 == 0){
+            sim.triggerEvent(ADXL345_ACTIVITY, 0x10 << (rand() % 3));
+        }
+        if(!sim.isInterruptActive(INT_PIN_1) && !sim.isInterruptActive(INT_PIN_2)){
+            continue;
+        }
+        r.interrupts++;
+        sim.resetCounters();
+        size_t before = r.samples.size();
+        auto start = std::chrono::steady_clock::now();
+        if(useDispatcher){
+            r.lastRank = -1;
+            dispatcher.onInterrupt();   // normally called by the ISR
+            dispatcher.service();
+        }
+        else{
+            uint8_t ints = acc.readAndClearInterrupts();
+            if(acc.checkInterrupt(ints, ADXL345_WATERMARK)){
+                xyzInt16 buf[32];
+                uint8_t n = acc.readFifo(buf, 32);
+                r.samples.insert(r.samples.end(), buf, buf + n);
+            }
+            if(acc.checkInterrupt(ints, ADXL345_SINGLE_TAP)){
+                r.taps.push_back(acc.getActTapStatus());
+            }
+            if(acc.checkInterrupt(ints, ADXL345_ACTIVITY)){
+                r.activities++;
+            }
+        }
+        r.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        uint32_t entries = r.samples.size() - before;
+        r.statusTransactions += sim.getTransactions() - entries;
+        r.statusBytes += sim.getBytes() - entries * (ADXL345_Bus::ADXL345_FIFO_ENTRY_SIZE + 1);
+    }
+    r.acc = nullptr;
+    return r;
+}
+
+int main(){
+    Result manual = run(false);
+    Result disp = run(true);
+    bool same = manual.samples.size() == disp.samples.size() && manual.taps == disp.taps
+             && manual.activities == disp.activities && manual.interrupts == disp.interrupts;
+    for(size_t i=0; same && i<manual.samples.size(); i++){
+        same = manual.samples[i].x == disp.samples[i].x && manual.samples[i].y == disp.samples[i].y
+            && manual.samples[i].z == disp.samples[i].z;
+    }
+    bool retry = retryAfterReadError();
+    bool ok = same && disp.orderErrors == 0 && retry;
+    printf("method,interrupts,samples,taps,activities,status_transactions_per_int,status_bytes_per_int,"
+           "host_ns_per_int\n");
+    const Result *res[2] = {&manual, &disp};
+    const char *names[2] = {"manual", "dispatcher"};
+    for(int i=0; i<2; i++){
+        printf("%s,%u,%u,%u,%u,%.2f,%.2f,%.0f\n", names[i], (unsigned)res[i]->interrupts,
+               (unsigned)res[i]->samples.size(), (unsigned)res[i]->taps.size(), (unsigned)res[i]->activities,
+               static_cast<double>(res[i]->statusTransactions) / res[i]->interrupts,
+               static_cast<double>(res[i]->statusBytes) / res[i]->interrupts, res[i]->ns / res[i]->interrupts);
+    }
+    printf("same_results,%s\npriority_order,%s\n", same ? "yes" : "NO", disp.orderErrors == 0 ? "yes" : "NO");
+    printf("retry_after_read_error,%s\n", retry ? "yes" : "NO");
+    return ok ? 0 : 1;
+}
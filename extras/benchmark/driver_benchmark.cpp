@@ -0,0 +1,135 @@
+/******************************************************************************
+ *
+ * Host benchmark for the hot paths of the ADXL345_WE library. Each case 
+ * runs against ADXL345_SimBus and reports the CPU time per call (including
+ * the simulation), and the bus transactions and bytes per call as counted
+ * by the simulation. The CPU time is only meaningful to compare builds on
+ * the same machine, the bus figures are exact.
+ *
+ * Output is CSV, or JSON with --json. Build with CMakeLists.txt in this
+ * directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Fixed.h"
+#include "ADXL345_AutoCal.h"
+#include "ADXL345_Filter.h"
+
+struct BenchResult
+{
+    const char *name;
+    uint32_t calls;
+    double nsPerCall;
+    double transactionsPerCall;
+    double bytesPerCall;
+};
+
+static volatile float sink;
+
+/* setup runs before each call and is not measured, e.g. to refill the FIFO */
+template <typename Setup, typename Func>
+static BenchResult run(const char *name, ADXL345_SimBus &sim, uint32_t calls, Setup setup, Func func){
+    std::chrono::steady_clock::duration total{0};
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    for(uint32_t i=0; i<calls; i++){
+        setup();
+        sim.resetCounters();
+        auto start = std::chrono::steady_clock::now();
+        func();
+        total += std::chrono::steady_clock::now() - start;
+        transactions += sim.getTransactions();
+        bytes += sim.getBytes();
+    }
+    BenchResult res;
+    res.name = name;
+    res.calls = calls;
+    res.nsPerCall = std::chrono::duration<double, std::nano>(total).count() / calls;
+    res.transactionsPerCall = static_cast<double>(transactions) / calls;
+    res.bytesPerCall = static_cast<double>(bytes) / calls;
+    return res;
+}
+
+int main(int argc, char **argv){
+    bool json = (argc > 1) && (strcmp(argv[1], "--json") == 0);
+    const uint32_t calls = 20000;
+
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    sim.setAcceleration(xyzFloat(0.12, -0.34, 0.93));
+    sim.generateSamples(1);
+    auto none = [](){};
+    auto fillFifo = [&](){ 
+        acc.setFifoMode(ADXL345_BYPASS);
+        acc.setFifoMode(ADXL345_STREAM);
+        sim.generateSamples(32);
+    };
+    xyzFloat f;
+    xyzInt16 i16;
+    xyzFloat fifoF[32];
+    xyzInt16 fifoI[32];
+
+    BenchResult results[24];
+    uint8_t n = 0;
+    results[n++] = run("init", sim, 2000, none, [&](){ acc.init(); });
+    sim.generateSamples(1);
+    results[n++] = run("getRawValues_xyzFloat", sim, calls, none, [&](){ acc.getRawValues(&f); sink = f.x; });
+    results[n++] = run("getRawValues_xyzInt16", sim, calls, none, [&](){ acc.getRawValues(&i16); sink = i16.x; });
+    results[n++] = run("getGValues", sim, calls, none, [&](){ acc.getGValues(&f); sink = f.x; });
+    results[n++] = run("getMilliGValues", sim, calls, none, [&](){ acc.getMilliGValues(&i16); sink = i16.x; });
+    results[n++] = run("getAngles", sim, calls, none, [&](){ acc.getAngles(&f); sink = f.x; });
+    results[n++] = run("getOrientation", sim, calls, none, [&](){ sink = acc.getOrientation(); });
+    results[n++] = run("getPitch_getRoll", sim, calls, none, [&](){ sink = acc.getPitch() + acc.getRoll(); });
+    results[n++] = run("getPitchRoll", sim, calls, none, [&](){ float p, r; acc.getPitchRoll(&p, &r); sink = p + r; });
+    results[n++] = run("readFifo32_xyzFloat", sim, 2000, fillFifo, [&](){ sink = acc.readFifo(fifoF, 32); });
+    results[n++] = run("readFifo32_xyzInt16", sim, 2000, fillFifo, [&](){ sink = acc.readFifo(fifoI, 32); });
+    ADXL345_AutoCal cal(&acc);
+    results[n++] = run("autocal_addSamples32", sim, calls, none, [&](){ sink = cal.addSamples(fifoI, 32); });
+    ADXL345_Filter lowPass;
+    lowPass.begin(ADXL345_LOW_PASS, 40.0, 3200.0, 4);
+    lowPass.setDecimation(32);
+    xyzInt16 filtered[32];
+    results[n++] = run("filter_lowpass4_dec32_block32", sim, calls, none, 
+                       [&](){ sink = lowPass.process(fifoI, filtered, 32); });
+    acc.enableRegisterCache();
+    results[n++] = run("setDataRate_cached", sim, calls, none, [&](){ acc.setDataRate(ADXL345_DATA_RATE_100); });
+    acc.enableRegisterCache(false);
+    results[n++] = run("setDataRate_uncached", sim, calls, none, [&](){ acc.setDataRate(ADXL345_DATA_RATE_100); });
+
+    ADXL345_SimBus fixedSim;
+    ADXL345_Fixed<ADXL345_SimBus, ADXL345_RANGE_2G, true> fixedAcc(fixedSim);
+    fixedAcc.init();
+    fixedSim.setAcceleration(xyzFloat(0.12, -0.34, 0.93));
+    fixedSim.generateSamples(1);
+    results[n++] = run("fixed_getGValues", fixedSim, calls, none, [&](){ fixedAcc.getGValues(&f); sink = f.x; });
+    results[n++] = run("fixed_getMilliGValues", fixedSim, calls, none, 
+                       [&](){ fixedAcc.getMilliGValues(&i16); sink = i16.x; });
+
+    if(json){
+        printf("[\n");
+        for(int i=0; i<n; i++){
+            printf("  {\"name\": \"%s\", \"calls\": %u, \"ns_per_call\": %.1f, "
+                   "\"transactions_per_call\": %.3f, \"bytes_per_call\": %.3f}%s\n",
+                   results[i].name, (unsigned)results[i].calls, results[i].nsPerCall, 
+                   results[i].transactionsPerCall, results[i].bytesPerCall, (i < n - 1) ? "," : "");
+        }
+        printf("]\n");
+    }
+    else{
+        printf("name,calls,ns_per_call,transactions_per_call,bytes_per_call\n");
+        for(int i=0; i<n; i++){
+            printf("%s,%u,%.1f,%.3f,%.3f\n", results[i].name, (unsigned)results[i].calls, results[i].nsPerCall, 
+                   results[i].transactionsPerCall, results[i].bytesPerCall);
+        }
+    }
+    return 0;
+}
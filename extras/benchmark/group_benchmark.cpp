@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_Group. Four simulated sensors run with
+ * different oscillator errors (up to 1.4 % apart) and sample phases. Each
+ * sample carries the time it was taken, so that the time difference of
+ * the samples in a frame can be checked. The run includes phases in which
+ * service() is not called or the frames are not read, so that FIFOs
+ * overflow and samples are lost.
+ *
+ * Reports frames, lost and dropped samples and the max. time difference
+ * within a frame in sample periods. Returns 1 if a frame contains samples
+ * one period or more apart. The sensors and service() run on a simulated
+ * clock (setHostMicros()) with 4 s of irregular poll intervals, so the
+ * result is deterministic. Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Group.h"
+
+static constexpr uint8_t SENSORS        {4};
+static constexpr uint8_t DEPTH          {16};
+static constexpr float RATE_HZ          {400.0};
+static constexpr float WRAP_PERIODS     {32.0};     // the time stamp in a sample wraps around
+static constexpr float RAW_PER_PERIOD   {100.0};
+
+/* The sample source writes the time of the sample, in nominal periods, into x */
+struct Clock
+{
+    float periodUs;     // true period of this sensor
+    float phaseUs;      // first sample at (periodUs - phaseUs) after the start
+    uint32_t samples;
+};
+
+static bool nextSample(void *context, xyzFloat *gVal){
+    Clock *c = static_cast<Clock *>(context);
+    c->samples++;
+    float periods = (c->samples * c->periodUs - c->phaseUs) * RATE_HZ / 1000000.0;
+    float stamp = fmod(periods, WRAP_PERIODS) * RAW_PER_PERIOD - WRAP_PERIODS * RAW_PER_PERIOD / 2;
+    *gVal = xyzFloat(stamp * ADXL345_WE::MILLI_G_PER_LSB / 1000.0, 0.0, 1.0);
+    return true;
+}
+
+static float stampOf(const xyzInt16 &raw){
+    return (raw.x + WRAP_PERIODS * RAW_PER_PERIOD / 2) / RAW_PER_PERIOD;
+}
+
+int main(){
+    const float ppm[SENSORS] = {0.0, 8000.0, -6000.0, 2500.0};
+    const float phase[SENSORS] = {100.0, 1900.0, 700.0, 2400.0};
+    ADXL345_SimBus sims[SENSORS];
+    ADXL345_WE accs[SENSORS] = {ADXL345_WE(&sims[0]), ADXL345_WE(&sims[1]), ADXL345_WE(&sims[2]),
+                                ADXL345_WE(&sims[3])};
+    ADXL345_WE *accPtrs[SENSORS];
+    Clock clocks[SENSORS];
+    for(int i=0; i<SENSORS; i++){
+        accs[i].init();
+        accs[i].setRange(ADXL345_RANGE_16G);
+        accs[i].setMeasureMode(true);
+        sims[i].setDataRateError(ppm[i]);
+        clocks[i] = {1000000.0f / (RATE_HZ * (1.0f + ppm[i] / 1000000.0f)), phase[i], 0};
+        sims[i].setSampleSource(nextSample, &clocks[i]);
+        accPtrs[i] = &accs[i];
+    }
+    xyzInt16 queues[SENSORS * DEPTH];
+    ADXL345_Group group(accPtrs, SENSORS, queues, DEPTH);
+
+    for(int i=0; i<SENSORS; i++){
+        sims[i].advanceMicros(phase[i]);    // no sample yet, sets the phase
+    }
+    const unsigned long start = 1000;
+    setHostMicros(start);
+    group.begin(ADXL345_DATA_RATE_400);
+    uint32_t seed = 7;
+    uint32_t frames = 0;
+    float maxDiff = 0.0;
+    for(unsigned long elapsed = 0; elapsed < 4000000UL; ){
+        seed = seed * 1103515245UL + 12345UL;
+        unsigned long step = 300 + ((seed >> 16) % 600);   // poll interval in µs
+        for(int i=0; i<SENSORS; i++){
+            sims[i].advanceMicros(step);
+        }
+        elapsed += step;
+        setHostMicros(start + elapsed);
+        bool stallService = (elapsed > 1000000UL && elapsed < 1085000UL)
+                         || (elapsed > 1800000UL && elapsed < 2000000UL);
+        bool stallRead = (elapsed > 2600000UL && elapsed < 2800000UL);
+        if(!stallService){
+            group.service();
+        }
+        xyzInt16 frame[SENSORS];
+        while(!stallRead && group.readFrame(frame)){
+            float t0 = stampOf(frame[0]);
+            for(int i=1; i<SENSORS; i++){
+                float d = stampOf(frame[i]) - t0;
+                d -= WRAP_PERIODS * floor(d / WRAP_PERIODS + 0.5);
+                maxDiff = fmax(maxDiff, fabs(d));
+            }
+            frames++;
+        }
+    }
+
+    bool ok = (maxDiff < 1.0) && (frames > 0);
+    printf("frames,full_fifos,dropped,lost_0,lost_1,lost_2,lost_3,max_diff_periods\n");
+    printf("%u,%u,%u,%u,%u,%u,%u,%.2f\n", (unsigned)frames, (unsigned)group.getFullFifos(),
+           (unsigned)group.getDroppedSamples(), (unsigned)group.getLostSamples(0), (unsigned)group.getLostSamples(1),
+           (unsigned)group.getLostSamples(2), (unsigned)group.getLostSamples(3), maxDiff);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
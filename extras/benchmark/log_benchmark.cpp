@@ -0,0 +1,168 @@
+/******************************************************************************
+ *
+ * Host benchmark and round trip check for the log format in ADXL345_Log.h.
+ * The simulated sensor delivers a sensor at rest (noise only) and a
+ * vibrating one. The FIFO contents are encoded directly from the drain
+ * buffer, then decoded in chunks of random length. Reports the bytes per
+ * sample and the time per sample for encoding and decoding. A second pass
+ * damages the stream (flipped and lost bytes) and checks that the decoder
+ * finds the next sync frame: at least 80 % of the samples must be decoded,
+ * and each damaged byte may make at most one sync interval (256 samples)
+ * wrong, since the differences have no CRC.
+ * Returns 1 if a check fails.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Log.h"
+
+static constexpr uint32_t SAMPLES      {32000};
+static constexpr uint16_t SYNC_INTERVAL {256};
+
+struct Signal
+{
+    float vibrationAmp;
+    uint32_t sample;
+    uint32_t seed;
+};
+
+static float noise(Signal *s){
+    s->seed = s->seed * 1103515245UL + 12345UL;
+    return ((s->seed >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+}
+
+static bool nextSample(void *context, xyzFloat *gVal){
+    Signal *s = static_cast<Signal *>(context);
+    float t = s->sample++ / 3200.0;
+    float vib = s->vibrationAmp * sin(2 * M_PI * 400.0 * t);
+    *gVal = xyzFloat(0.02 + 0.2 * vib, -0.01 + 0.4 * vib, 1.0 + vib)
+          + xyzFloat(noise(s), noise(s), noise(s)) * 0.008;
+    return true;
+}
+
+struct Result
+{
+    double bytesPerSample;
+    double encodeNs;
+    double decodeNs;
+    bool roundTrip;
+    bool damaged;
+};
+
+static Result run(float vibrationAmp){
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setDataRate(ADXL345_DATA_RATE_3200);
+    acc.setRange(ADXL345_RANGE_4G);
+    acc.setFullRes(true);
+    Signal signal = {vibrationAmp, 0, 7};
+    sim.setSampleSource(nextSample, &signal);
+    acc.setFifoMode(ADXL345_STREAM);
+
+    ADXL345_LogEncoder enc;
+    enc.begin(SYNC_INTERVAL);
+    std::vector<xyzInt16> samples;
+    std::vector<uint8_t> stream(ADXL345_LogEncoder::ADXL345_LOG_HEADER_BYTES);
+    stream.resize(enc.writeHeader(&acc, stream.data()));
+    xyzInt16 fifo[32];
+    uint8_t out[32 * ADXL345_LogEncoder::ADXL345_LOG_SYNC_BYTES];
+    double encNs = 0.0;
+    while(samples.size() < SAMPLES){
+        sim.generateSamples(32);
+        uint8_t n = acc.readFifo(fifo, 32);
+        auto start = std::chrono::steady_clock::now();
+        size_t len = enc.encode(fifo, n, out);
+        encNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        stream.insert(stream.end(), out, out + len);
+        samples.insert(samples.end(), fifo, fifo + n);
+    }
+
+    /* Round trip in chunks of random length, the undecoded rest is passed again */
+    Result res;
+    res.bytesPerSample = static_cast<double>(stream.size()) / samples.size();
+    res.encodeNs = encNs / samples.size();
+    ADXL345_LogDecoder dec;
+    dec.reset();
+    std::vector<xyzInt16> decoded(samples.size());
+    std::vector<uint32_t> index(samples.size());
+    size_t pos = 0, avail = 0;
+    uint32_t count = 0;
+    double decNs = 0.0;
+    while(pos < stream.size()){
+        avail = fmin(stream.size(), avail + 1 + rand() % 200);
+        size_t used;
+        auto start = std::chrono::steady_clock::now();
+        count += dec.decode(stream.data() + pos, avail - pos, &used, &decoded[count], &index[count],
+                            decoded.size() - count);
+        decNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        pos += used;
+        if(used == 0 && avail == stream.size()){
+            break;
+        }
+    }
+    res.decodeNs = decNs / samples.size();
+    adxl345_logHeader header;
+    xyzFloat offset, factor;
+    acc.getScaling(&offset, &factor);
+    res.roundTrip = count == samples.size() && dec.getErrors() == 0 && dec.getHeader(&header)
+                  && header.factor.z == factor.z && header.syncInterval == SYNC_INTERVAL;
+    for(uint32_t i=0; res.roundTrip && i<count; i++){
+        res.roundTrip = index[i] == i && decoded[i].x == samples[i].x && decoded[i].y == samples[i].y
+                     && decoded[i].z == samples[i].z;
+    }
+
+    /* Damaged stream: most samples must survive. The differences have no CRC, so a damaged byte
+       can make the samples up to the next sync frame wrong, but not more. */
+    std::vector<uint8_t> bad;
+    uint32_t damages = 0;
+    for(size_t i=0; i<stream.size(); i++){
+        int r = rand() % 20000;
+        damages += (r <= 1);
+        if(r == 0){
+            continue;                           // lost byte
+        }
+        bad.push_back((r == 1) ? stream[i] ^ (1 << (rand() % 8)) : stream[i]);  // flipped bit
+    }
+    dec.reset();
+    size_t used;
+    count = dec.decode(bad.data(), bad.size(), &used, decoded.data(), index.data(), decoded.size());
+    res.damaged = count > samples.size() * 0.8 && dec.getErrors() > 0;
+    uint32_t wrong = 0;
+    for(uint32_t i=0; i<count; i++){
+        if(index[i] >= samples.size() || decoded[i].x != samples[index[i]].x || decoded[i].y != samples[index[i]].y
+           || decoded[i].z != samples[index[i]].z){
+            wrong++;
+        }
+    }
+    printf("# damaged: %u damaged bytes, %u errors, %u of %u samples decoded, %u wrong\n", (unsigned)damages,
+           (unsigned)dec.getErrors(), (unsigned)count, (unsigned)samples.size(), (unsigned)wrong);
+    res.damaged = res.damaged && wrong <= SYNC_INTERVAL * damages;
+    return res;
+}
+
+int main(){
+    srand(3);
+    const char *names[2] = {"rest", "vibration_1.5g_400hz"};
+    const float amps[2] = {0.0, 1.5};
+    bool ok = true;
+    printf("signal,bytes_per_sample,encode_ns_per_sample,decode_ns_per_sample,round_trip,damaged_stream\n");
+    for(int i=0; i<2; i++){
+        Result r = run(amps[i]);
+        printf("%s,%.2f,%.1f,%.1f,%s,%s\n", names[i], r.bytesPerSample, r.encodeNs, r.decodeNs,
+               r.roundTrip ? "ok" : "FAIL", r.damaged ? "ok" : "FAIL");
+        ok = ok && r.roundTrip && r.damaged;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *
+ * Host tool: decodes a log written with ADXL345_LogEncoder (ADXL345_Log.h),
+ * e.g. from a flash file or a capture of ADXL345_fifo_log.ino, and prints
+ * CSV: sample number, time in s, x, y, z in g. The scaling is taken from
+ * the last header before the samples. A summary goes to stderr.
+ *
+ *   ./log_decode capture.bin > capture.csv
+ *   ./log_decode --raw capture.bin     (raw values instead of g)
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "ADXL345_Log.h"
+
+static constexpr uint16_t CHUNK   {4096};
+static constexpr uint16_t SAMPLES {1024};
+
+int main(int argc, char *argv[]){
+    bool raw = false;
+    const char *path = nullptr;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--raw") == 0){
+            raw = true;
+        }
+        else{
+            path = argv[i];
+        }
+    }
+    FILE *file = path ? fopen(path, "rb") : stdin;
+    if(!file){
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+
+    ADXL345_LogDecoder dec;
+    dec.reset();
+    static uint8_t data[2 * CHUNK];
+    static xyzInt16 rawVal[SAMPLES];
+    static xyzFloat gVal[SAMPLES];
+    static uint32_t index[SAMPLES];
+    size_t avail = 0;
+    uint32_t total = 0;
+    bool eof = false;
+    printf(raw ? "sample,time_s,x_raw,y_raw,z_raw\n" : "sample,time_s,x_g,y_g,z_g\n");
+    while(!eof || avail > 0){
+        if(!eof){
+            size_t n = fread(data + avail, 1, sizeof(data) - avail, file);
+            eof = (n == 0);
+            avail += n;
+        }
+        size_t used;
+        uint16_t n = dec.decode(data, avail, &used, rawVal, index, SAMPLES);
+        adxl345_logHeader header;
+        bool scaled = dec.getHeader(&header);
+        if(scaled){
+            adxl345_rawToG(rawVal, header.offset, header.factor, gVal, n);
+        }
+        for(uint16_t i=0; i<n; i++){
+            double t = scaled ? index[i] / header.rateHz : 0.0;
+            if(raw || !scaled){
+                printf("%u,%.6f,%d,%d,%d\n", (unsigned)index[i], t, rawVal[i].x, rawVal[i].y, rawVal[i].z);
+            }
+            else{
+                printf("%u,%.6f,%.4f,%.4f,%.4f\n", (unsigned)index[i], t, gVal[i].x, gVal[i].y, gVal[i].z);
+            }
+        }
+        total += n;
+        memmove(data, data + used, avail - used);
+        avail -= used;
+        if(n == 0 && used == 0 && eof){
+            break;      // incomplete rest at the end of the file
+        }
+    }
+    if(file != stdin){
+        fclose(file);
+    }
+    fprintf(stderr, "%u samples, %u headers, %u sync frames, %u errors\n", (unsigned)total,
+            (unsigned)dec.getHeaderCount(), (unsigned)dec.getSyncCount(), (unsigned)dec.getErrors());
+    return 0;
+}
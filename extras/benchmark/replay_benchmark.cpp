@@ -0,0 +1,152 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_RecordBus and ADXL345_ReplayBus. A session
+ * with the simulated sensor (FIFO stream, watermark and tap interrupts) is
+ * recorded, once with all accesses and once with the data only. Then the
+ * session is replayed into a new driver object: with the same code, with a
+ * modified access pattern (other reads, no interrupt handling) and from the
+ * data recording. Each replay has to deliver exactly the recorded samples.
+ * Reports the size of the recordings, the mismatches and skipped records
+ * and the time per sample. Returns 1 if a check fails.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Record.h"
+
+static constexpr uint16_t ROUNDS {2000};
+
+struct Session
+{
+    std::vector<xyzInt16> samples;
+    std::vector<uint8_t> ints;
+    double ns;
+};
+
+static void toVector(void *context, const uint8_t *data, size_t len){
+    std::vector<uint8_t> *v = static_cast<std::vector<uint8_t> *>(context);
+    v->insert(v->end(), data, data + len);
+}
+
+static bool vibration(void *context, xyzFloat *gVal){
+    uint32_t *sample = static_cast<uint32_t *>(context);
+    float t = (*sample)++ / 800.0;
+    *gVal = xyzFloat(0.1 * sin(2 * M_PI * 13.0 * t), 0.05, 1.0 + 0.4 * sin(2 * M_PI * 71.0 * t));
+    return true;
+}
+
+static void setup(ADXL345_WE &acc){
+    acc.init();
+    acc.setDataRate(ADXL345_DATA_RATE_800);
+    acc.setRange(ADXL345_RANGE_4G);
+    acc.setFullRes(true);
+    acc.setInterrupt(ADXL345_SINGLE_TAP, INT_PIN_1);
+    acc.setFifoParameters(ADXL345_TRIGGER_INT_1, 16);
+    acc.setInterrupt(ADXL345_WATERMARK, INT_PIN_2);
+    acc.setFifoMode(ADXL345_STREAM);
+}
+
+/* sim == nullptr: replay. modified: other accesses than during the recording. */
+static Session run(ADXL345_WE &acc, ADXL345_SimBus *sim, bool modified){
+    Session s;
+    xyzInt16 buf[32];
+    srand(5);
+    setup(acc);
+    auto start = std::chrono::steady_clock::now();
+    for(uint16_t r=0; r<ROUNDS; r++){
+        uint16_t n = 8 + rand() % 20;
+        bool tap = rand() % 50 == 0;
+        if(sim){
+            sim->generateSamples(n);
+            if(tap){
+                sim->triggerEvent(ADXL345_SINGLE_TAP, 0x01);
+            }
+        }
+        if(modified){
+            acc.getRange();
+            acc.getFifoStatus();   // extra read, not in the recording
+        }
+        else{
+            uint8_t ints = acc.readAndClearInterrupts();
+            s.ints.push_back(ints);
+            if(acc.checkInterrupt(ints, ADXL345_SINGLE_TAP)){
+                s.ints.push_back(acc.getActTapStatus());
+            }
+        }
+        uint8_t got = acc.readFifo(buf, 32);
+        s.samples.insert(s.samples.end(), buf, buf + got);
+    }
+    s.ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return s;
+}
+
+static bool sameSamples(const Session &a, const Session &b){
+    if(a.samples.size() != b.samples.size()){
+        return false;
+    }
+    for(size_t i=0; i<a.samples.size(); i++){
+        if(a.samples[i].x != b.samples[i].x || a.samples[i].y != b.samples[i].y || a.samples[i].z != b.samples[i].z){
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(){
+    std::vector<uint8_t> recAll, recData;
+    Session orig, origData;
+    {
+        ADXL345_SimBus sim;
+        uint32_t sample = 0;
+        sim.setSampleSource(vibration, &sample);
+        ADXL345_RecordBus recorder(&sim, toVector, &recAll);
+        ADXL345_WE acc(&recorder);
+        orig = run(acc, &sim, false);
+    }
+    {
+        ADXL345_SimBus sim;
+        uint32_t sample = 0;
+        sim.setSampleSource(vibration, &sample);
+        ADXL345_RecordBus recorder(&sim, toVector, &recData, ADXL345_RECORD_DATA);
+        ADXL345_WE acc(&recorder);
+        origData = run(acc, &sim, false);
+    }
+
+    printf("replay,recording_bytes,bytes_per_sample,samples,identical,mismatches,skipped,ns_per_sample\n");
+    printf("record_sim,%u,%.2f,%u,-,-,-,%.1f\n", (unsigned)recAll.size(),
+           static_cast<double>(recAll.size()) / orig.samples.size(), (unsigned)orig.samples.size(),
+           orig.ns / orig.samples.size());
+    struct Case
+    {
+        const char *name;
+        std::vector<uint8_t> *rec;
+        const Session *ref;
+        bool modified;
+    } cases[3] = {{"same_code", &recAll, &orig, false}, {"modified_access", &recAll, &orig, true},
+                  {"data_only", &recData, &origData, false}};
+    bool ok = true;
+    for(int i=0; i<3; i++){
+        ADXL345_ReplayBus replay(cases[i].rec->data(), cases[i].rec->size());
+        ADXL345_WE acc(&replay);
+        Session s = run(acc, nullptr, cases[i].modified);
+        bool identical = sameSamples(s, *cases[i].ref) && (cases[i].modified || s.ints == cases[i].ref->ints);
+        bool pass = identical && replay.isAtEnd() && (i != 0 || (replay.getMismatches() == 0 && replay.getSkipped() == 0));
+        printf("%s,%u,%.2f,%u,%s,%u,%u,%.1f\n", cases[i].name, (unsigned)cases[i].rec->size(),
+               static_cast<double>(cases[i].rec->size()) / s.samples.size(), (unsigned)s.samples.size(),
+               pass ? "yes" : "NO", (unsigned)replay.getMismatches(), (unsigned)replay.getSkipped(),
+               s.ns / s.samples.size());
+        ok = ok && pass;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *
+ * Host tool: replays a recording of ADXL345_RecordBus (ADXL345_Record.h),
+ * e.g. a capture of ADXL345_record.ino, into the driver and prints the FIFO
+ * samples as CSV: recorded time in µs, raw x, y, z. A summary with the
+ * mismatches and skipped records goes to stderr. Use it as a template to
+ * run your own processing on recorded data.
+ *
+ *   ./replay_dump capture.axr > samples.csv
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <vector>
+#include "ADXL345_Record.h"
+#include "ADXL345_WE.h"
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        fprintf(stderr, "Usage: %s recording\n", argv[0]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if(!file){
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> recording;
+    uint8_t chunk[4096];
+    size_t n;
+    while((n = fread(chunk, 1, sizeof(chunk), file)) > 0){
+        recording.insert(recording.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    ADXL345_ReplayBus replay(recording.data(), recording.size());
+    ADXL345_WE acc(&replay);
+    if(!acc.init()){
+        fprintf(stderr, "No valid recording\n");
+        return 1;
+    }
+    xyzInt16 buf[32];
+    uint32_t total = 0;
+    printf("time_us,x_raw,y_raw,z_raw\n");
+    while(!replay.isAtEnd()){
+        uint8_t got = acc.readFifo(buf, 32);
+        for(uint8_t i=0; i<got; i++){
+            printf("%u,%d,%d,%d\n", (unsigned)replay.getRecordMicros(), buf[i].x, buf[i].y, buf[i].z);
+        }
+        total += got;
+    }
+    fprintf(stderr, "%u samples, %u mismatches, %u skipped records\n", (unsigned)total,
+            (unsigned)replay.getMismatches(), (unsigned)replay.getSkipped());
+    return 0;
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ *
+ * Host check of the raw -> g scaling of the ADXL345_WE library. For all
+ * ranges and resolutions and several calibrations it compares the integer
+ * milli-g path (rawToMilliG(), getMilliGValues()) with the float path
+ * (rawToGValues(), getGValues()) over the complete raw value range.
+ * Then it checks getGValues() against the acceleration of a simulated
+ * sensor with offset and gain errors, with the offsets corrected by the
+ * library and in OFSX-Z (enableHardwareOffsets()).
+ *
+ * Prints the max. deviation per case and returns 1 if it exceeds 1 mg, or
+ * one LSB for the comparison with the simulated sensor.
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "ADXL345_SimBus.h"
+
+static constexpr long MAX_MG_DIFF {1};
+
+struct Calibration
+{
+    const char *name;
+    xyzFloat offset;
+    xyzFloat corr;
+};
+
+static long mgDiff(int16_t mg, float g){
+    return labs(mg - lround(1000.0 * g));
+}
+
+/* Returns the max. difference in mg over all raw values of the current range and resolution
+   and some samples read via the bus */
+static long maxMilliGDiff(ADXL345_SimBus &sim, ADXL345_WE &acc, int16_t rawMax){
+    long diff = 0;
+    for(int32_t r=-rawMax; r<rawMax; r++){
+        const xyzInt16 raw(r, -r - 1, r / 2);
+        xyzInt16 mg;
+        xyzFloat g;
+        acc.rawToMilliG(raw, &mg);
+        acc.rawToGValues(&raw, &g, 1);
+        diff = std::max({diff, mgDiff(mg.x, g.x), mgDiff(mg.y, g.y), mgDiff(mg.z, g.z)});
+    }
+    for(int i=0; i<100; i++){
+        float a = i * 0.0631;
+        sim.setAcceleration(xyzFloat(1.7 * sin(a), -1.3 * cos(a * 0.7), 0.9 * sin(a * 1.3) + 0.1));
+        sim.generateSamples(1);
+        xyzInt16 mg;
+        xyzFloat g;
+        acc.getMilliGValues(&mg);
+        acc.getGValues(&g);
+        diff = std::max({diff, mgDiff(mg.x, g.x), mgDiff(mg.y, g.y), mgDiff(mg.z, g.z)});
+    }
+    return diff;
+}
+
+/* Returns the max. difference in mg between getGValues() and the acceleration of the simulated
+   sensor, whose error matches the calibration */
+static long maxGError(ADXL345_SimBus &sim, ADXL345_WE &acc){
+    long diff = 0;
+    for(int i=0; i<100; i++){
+        float a = i * 0.0631;
+        const xyzFloat g(1.7 * sin(a), -1.3 * cos(a * 0.7), 0.9 * sin(a * 1.3) + 0.1);
+        sim.setAcceleration(g);
+        sim.generateSamples(1);
+        xyzFloat gVal;
+        acc.getGValues(&gVal);
+        const xyzFloat d = (gVal - g) * 1000.0;
+        diff = std::max({diff, lround(fabs(d.x)), lround(fabs(d.y)), lround(fabs(d.z))});
+    }
+    return diff;
+}
+
+int main(){
+    const adxl345_range ranges[4] = {ADXL345_RANGE_2G, ADXL345_RANGE_4G, ADXL345_RANGE_8G, ADXL345_RANGE_16G};
+    const char *rangeNames[4] = {"2g", "4g", "8g", "16g"};
+    const Calibration cals[4] = {
+        {"none", xyzFloat(0, 0, 0), xyzFloat(1, 1, 1)},
+        {"typical", xyzFloat(9.5, -8.0, 30.5), xyzFloat(0.9324, 0.9861, 0.9805)},
+        {"large", xyzFloat(-61.3, 44.8, -97.2), xyzFloat(1.1378, 0.8615, 1.2102)},
+        {"corr_max", xyzFloat(3.1, -2.2, 0.7), xyzFloat(7.9, 0.13, 2.5)}
+    };
+
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setMeasureMode(true);
+    bool ok = true;
+
+    printf("check,range,resolution,calibration,max_diff_mg\n");
+    for(const Calibration &cal : cals){
+        acc.setCalibration(cal.offset, cal.corr);
+        for(int fullRes=0; fullRes<2; fullRes++){
+            acc.setFullRes(fullRes);
+            for(int r=0; r<4; r++){
+                acc.setRange(ranges[r]);
+                int16_t rawMax = fullRes ? (512 << r) : 512;
+                if(cal.corr.x > 4.0){
+                    rawMax /= 8;    // keeps the result within int16_t
+                }
+                long diff = maxMilliGDiff(sim, acc, rawMax);
+                ok &= (diff <= MAX_MG_DIFF);
+                printf("milli_g,%s,%s,%s,%ld\n", rangeNames[r], fullRes ? "full" : "10bit", cal.name, diff);
+            }
+        }
+    }
+
+    /* The same g values with the offsets in OFSX-Z, which must survive range changes. The
+       allowed error is one LSB of the current range and resolution. */
+    for(int c=1; c<3; c++){
+        const Calibration &cal = cals[c];
+        const xyzFloat gain(1.0 / cal.corr.x, 1.0 / cal.corr.y, 1.0 / cal.corr.z);
+        sim.setSensorError(cal.offset * ADXL345_WE::MILLI_G_PER_LSB / 1000.0, gain);
+        acc.setCalibration(cal.offset, cal.corr);
+        for(int hw=0; hw<2; hw++){
+            acc.enableHardwareOffsets(hw);
+            for(int fullRes=0; fullRes<2; fullRes++){
+                acc.setFullRes(fullRes);
+                for(int r=0; r<4; r++){
+                    acc.setRange(ranges[r]);
+                    const float lsbMilliG = ADXL345_WE::MILLI_G_PER_LSB * acc.getRangeFactor()
+                                          * std::max({cal.corr.x, cal.corr.y, cal.corr.z});
+                    long diff = maxGError(sim, acc);
+                    ok &= (diff <= lround(lsbMilliG));
+                    printf("%s,%s,%s,%s,%ld\n", hw ? "hw_offset_on" : "hw_offset_off", rangeNames[r],
+                           fullRes ? "full" : "10bit", cal.name, diff);
+                }
+            }
+        }
+    }
+
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
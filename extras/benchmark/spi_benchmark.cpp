@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * Host benchmark for the SPI transport. A model of the ADXL345 SPI 
+ * interface (on top of ADXL345_SimBus) is attached to the host SPIClass,
+ * so that the real ADXL345_SPIBus code runs. The bus time is modeled as
+ * 8 bits per clock and byte plus all delayMicroseconds() calls. The 
+ * benchmark reports the payload rate for FIFO drains and single reads at
+ * different clock speeds and CS setup times. It also checks the time 
+ * between two reads of the data registers, which pop the FIFO: it returns
+ * 1 if this is less than 5 µs (up to the end of the next address byte).
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "ADXL345_SimBus.h"
+
+static constexpr int CS_PIN {10};
+
+static constexpr unsigned long FIFO_POP_NANOS {5000};
+
+static bool coversData(uint8_t first, uint8_t count){
+    return first <= ADXL345_WE::ADXL345_DATAZ1 && first + count > ADXL345_WE::ADXL345_DATAX0;
+}
+
+/* Decodes SPI frames (command byte, data bytes) and applies them to the register model. It also
+   measures the bus time from the end of a data register read (FIFO pop) to the end of the
+   address byte of the next one. */
+class SimSPIDevice : public ADXL345_HostSPIDevice
+{
+    public:
+        SimSPIDevice(ADXL345_SimBus &s) : sim(s) {}
+
+        void setClock(unsigned long clock) { addrNanos = 8000000000ULL / clock; }
+        void resetMinPopGap() { minPopGap = ~0ULL; havePop = false; }
+        unsigned long long getMinPopGap() { return minPopGap; }
+
+        void setSelected(bool selected) override {
+            if(selected){
+                selectNanos = SPI.getBusNanos();
+            }
+            if(!selected && pos > 1){
+                if(read && coversData(reg, pos - 1)){
+                    popNanos = SPI.getBusNanos();
+                    havePop = true;
+                }
+                if(read){
+                    uint8_t tmp[64];
+                    sim.readRegisters(reg, tmp, pos - 1); // side effects: FIFO pop, INT_SOURCE clear
+                }
+                else{
+                    sim.writeRegisters(reg, writeBuf, pos - 1);
+                }
+            }
+            pos = 0;
+        }
+
+        uint8_t exchange(uint8_t out) override {
+            if(pos == 0){
+                read = out & 0x80;
+                multi = out & 0x40;
+                reg = out & 0x3F;
+                if(read && havePop && coversData(reg, 1)){
+                    unsigned long long gap = selectNanos - popNanos + addrNanos;
+                    minPopGap = (gap < minPopGap) ? gap : minPopGap;
+                }
+                pos++;
+                return 0;
+            }
+            uint8_t in = 0;
+            if(read){
+                in = sim.peekRegister(reg + (multi ? pos - 1 : 0));
+            }
+            else if(static_cast<size_t>(pos - 1) < sizeof(writeBuf)){
+                writeBuf[pos - 1] = out;
+            }
+            pos++;
+            return in;
+        }
+
+    private:
+        ADXL345_SimBus &sim;
+        uint8_t pos = 0;
+        bool read = false;
+        bool multi = false;
+        uint8_t reg = 0;
+        uint8_t writeBuf[64];
+        unsigned long long addrNanos = 0;
+        unsigned long long selectNanos = 0;
+        unsigned long long popNanos = 0;
+        unsigned long long minPopGap = ~0ULL;
+        bool havePop = false;
+};
+
+/* Returns false if the FIFO got less than 5 µs between two reads */
+static bool runCase(ADXL345_SimBus &sim, SimSPIDevice &device, ADXL345_WE &acc, unsigned long clock,
+                    uint8_t csSetup){
+    acc.setSPIClockSpeed(clock);
+    device.setClock(clock);
+    device.resetMinPopGap();
+    acc.setSPICSSetupTime(csSetup);
+    xyzInt16 buf[32];
+    const int reps = 50;
+
+    uint8_t check = 0;
+    for(int r=0; r<reps; r++){
+        acc.setFifoMode(ADXL345_BYPASS);
+        acc.setFifoMode(ADXL345_STREAM);
+        sim.generateSamples(32);
+        SPI.resetCounters();
+        check = acc.readFifo(buf, 32);
+    }
+    double drainNanos = SPI.getBusNanos();   // of the last drain
+    unsigned long drainCalls = SPI.getTransferCalls();
+    printf("fifo_drain_32,%lu,%u,%.1f,%.0f,%lu,%u,%.2f\n", clock, csSetup, drainNanos / 1000.0, 
+           check * ADXL345_Bus::ADXL345_FIFO_ENTRY_SIZE * 1e9 / drainNanos, drainCalls, check,
+           device.getMinPopGap() / 1000.0);
+    bool ok = device.getMinPopGap() >= FIFO_POP_NANOS;
+
+    SPI.resetCounters();
+    device.resetMinPopGap();
+    xyzInt16 raw;
+    for(int r=0; r<reps; r++){
+        acc.getRawValues(&raw);
+    }
+    double rawNanos = SPI.getBusNanos() / static_cast<double>(reps);
+    printf("getRawValues,%lu,%u,%.1f,%.0f,%lu,1,%.2f\n", clock, csSetup, rawNanos / 1000.0, 6 * 1e9 / rawNanos, 
+           SPI.getTransferCalls() / reps, device.getMinPopGap() / 1000.0);
+    return ok && device.getMinPopGap() >= FIFO_POP_NANOS;
+}
+
+int main(){
+    ADXL345_SimBus sim;
+    SimSPIDevice device(sim);
+    SPI.attachDevice(CS_PIN, &device);
+    ADXL345_WE acc(CS_PIN, true);
+    if(!acc.init()){
+        printf("init failed\n");
+        return 1;
+    }
+    sim.setAcceleration(xyzFloat(0.1, 0.2, 0.97));
+    
+    printf("case,clock_hz,cs_setup_us,bus_us,payload_bytes_per_s,transfer_calls,entries,min_pop_gap_us\n");
+    bool ok = true;
+    ok &= runCase(sim, device, acc, 1000000, 0);
+    ok &= runCase(sim, device, acc, 5000000, 5);  // CS setup time of previous versions
+    ok &= runCase(sim, device, acc, 5000000, 0);
+    ok &= runCase(sim, device, acc, 8000000, 0);
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Host check of the FIFO time stamps and the data rate estimation
+ * (readFifo() with time stamps, see ADXL345_Timebase.h). The simulated
+ * sensor runs with several data rate errors (setDataRateError()) and is
+ * drained at irregular intervals on a simulated time line, so the result
+ * is deterministic. Since no sample is lost, the n-th sample was taken at
+ * n true periods after the start.
+ *
+ * Each run delivers 8000 samples. It reports the error of the estimated
+ * rate and the max. time stamp error after the first 256 samples. Returns 1 if the rate is off by more than
+ * 200 ppm or a time stamp by more than half a period.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "ADXL345_SimBus.h"
+
+static constexpr double MAX_RATE_ERR_PPM   {200.0};
+static constexpr double MAX_STAMP_ERR      {0.5};       // periods
+static constexpr uint32_t SETTLE_SAMPLES   {256};
+static constexpr uint32_t RUN_SAMPLES      {8000};
+
+struct Result
+{
+    double estimatedPpm;
+    double stampErr;        // periods
+};
+
+static Result run(adxl345_dataRate rate, float ppm){
+    const double nominalHz = ADXL345_WE::dataRateToHz(rate);
+    const double truePeriod = 1000000.0 / (nominalHz * (1.0 + ppm / 1000000.0));
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    unsigned long t = 1000;
+    setHostMicros(t);
+    acc.init();
+    acc.setDataRate(rate);
+    acc.setMeasureMode(true);
+    sim.setDataRateError(ppm);
+    acc.setFifoMode(ADXL345_STREAM);
+
+    const unsigned long start = t;     // the sim starts counting periods here
+    uint32_t seed = 7;
+    uint32_t n = 0;
+    Result res = {0.0, 0.0};
+    xyzInt16 buf[32];
+    uint32_t stamps[32];
+    while(n < RUN_SAMPLES){
+        seed = seed * 1103515245UL + 12345UL;
+        /* between 4 and 28 nominal periods, so that the FIFO never overflows */
+        unsigned long step = (4.0 + 24.0 * ((seed >> 16) & 0x7FFF) / 32768.0) * 1000000.0 / nominalHz;
+        sim.advanceMicros(step);
+        t += step;
+        setHostMicros(t);
+        uint8_t got = acc.readFifo(buf, stamps, 32);
+        for(int i=0; i<got; i++){
+            n++;
+            if(n <= SETTLE_SAMPLES){
+                continue;
+            }
+            double trueStamp = start + n * truePeriod;
+            double err = fabs(static_cast<double>(stamps[i]) - trueStamp) / truePeriod;
+            res.stampErr = fmax(res.stampErr, err);
+        }
+    }
+    res.estimatedPpm = acc.getDataRateDriftPpm();
+    return res;
+}
+
+int main(){
+    const adxl345_dataRate rates[3] = {ADXL345_DATA_RATE_100, ADXL345_DATA_RATE_400, ADXL345_DATA_RATE_1600};
+    const float ppms[5] = {-30000.0, -8000.0, 0.0, 5000.0, 25000.0};
+    bool ok = true;
+    printf("rate_hz,true_ppm,estimated_ppm,rate_err_ppm,max_stamp_err_periods\n");
+    for(adxl345_dataRate rate : rates){
+        for(float ppm : ppms){
+            Result r = run(rate, ppm);
+            double rateErr = fabs(r.estimatedPpm - ppm);
+            ok &= (rateErr <= MAX_RATE_ERR_PPM) && (r.stampErr <= MAX_STAMP_ERR);
+            printf("%.0f,%.0f,%.0f,%.0f,%.3f\n", ADXL345_WE::dataRateToHz(rate), ppm, r.estimatedPpm,
+                   rateErr, r.stampErr);
+        }
+    }
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
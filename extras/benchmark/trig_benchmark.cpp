@@ -0,0 +1,144 @@
+/******************************************************************************
+ *
+ * Host benchmark for the trigonometric kernels of ADXL345_FastMath.h.
+ * Prints the maximum error against double precision and the time per call
+ * for each mode. The libm rows are the code of ADXL345_TRIG_LIBM, i.e. the
+ * double asin() / atan2() the driver always used. The snapshot rows time
+ * getAngles() and getPitchRoll() of ADXL345_Snapshot in each mode.
+ *
+ * The times are those of the host, which has a fast FPU. They say nothing
+ * about AVR or Cortex-M0, which emulate floating point in software.
+ *
+ * Returns 1 if pitch or roll of ADXL345_TRIG_FIXED deviate by more than
+ * 0.05° for g values up to 100 g (e.g. after a calibration with large
+ * correction factors).
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "ADXL345_WE.h"
+
+static constexpr int STEPS = 20001;
+static constexpr double MAX_PITCH_ROLL_ERR {0.05};   // degrees
+static volatile float sink;
+
+template <typename F>
+static double nsPerCall(F func){
+    auto start = std::chrono::steady_clock::now();
+    for(int rep=0; rep<20; rep++){
+        for(int i=0; i<STEPS; i++){
+            sink = func(i);
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (20.0 * STEPS);
+}
+
+static float arg(int i){
+    return -1.0f + 2.0f * i / (STEPS - 1);
+}
+
+static float angleArg(int i){
+    return -3.1415927f + 6.2831853f * i / (STEPS - 1);
+}
+
+/* The same code as ADXL345_TRIG_LIBM in ADXL345_Snapshot */
+static float libmAsinDeg(float x){
+    return (asin(x)) * 57.296;
+}
+
+static float libmAtan2Deg(float y, float x){
+    return (atan2(y, x) * 180.0) / M_PI;
+}
+
+static xyzFloat gArg(int i){
+    float a = angleArg(i);
+    return xyzFloat(0.7 * sinf(3 * a), 0.7 * cosf(a), 0.7 * sinf(a + 0.5));
+}
+
+/* Max. deviation of pitch and roll from double precision, for g vectors of the given length */
+static double pitchRollError(adxl345_trigMode mode, float length){
+    double err = 0.0;
+    for(int i=0; i<STEPS; i+=7){
+        xyzFloat g = gArg(i);
+        g = g * (length / sqrt(g.x * g.x + g.y * g.y + g.z * g.z));
+        float pitch, roll;
+        ADXL345_Snapshot(g, xyzFloat(), mode).getPitchRoll(&pitch, &roll);
+        double refPitch = atan2(-(double)g.x, sqrt((double)g.y * g.y + (double)g.z * g.z)) * 180.0 / M_PI;
+        double refRoll = atan2((double)g.y, (double)g.z) * 180.0 / M_PI;
+        double dRoll = fabs(roll - refRoll);
+        err = fmax(err, fmax(fabs(pitch - refPitch), fmin(dRoll, 360.0 - dRoll)));
+    }
+    return err;
+}
+
+int main(){
+    double errLibm = 0, errFast = 0, errFixed = 0;
+    for(int i=0; i<STEPS; i++){
+        float x = arg(i);
+        double ref = asin((double)x) * 180.0 / M_PI;
+        errLibm = fmax(errLibm, fabs(libmAsinDeg(x) - ref));
+        errFast = fmax(errFast, fabs(adxl345_fastAsinDeg(x) - ref));
+        errFixed = fmax(errFixed, fabs(adxl345_asinFixed((int32_t)(x * 16384), 16384) / 100.0 -
+                        asin((int32_t)(x * 16384) / 16384.0) * 180.0 / M_PI));
+    }
+    printf("kernel,mode,max_error_deg,ns_per_call\n");
+    printf("asin,libm,%.5f,%.2f\n", errLibm, nsPerCall([](int i){ return libmAsinDeg(arg(i)); }));
+    printf("asin,fast,%.5f,%.2f\n", errFast, nsPerCall([](int i){ return adxl345_fastAsinDeg(arg(i)); }));
+    printf("asin,fixed,%.5f,%.2f\n", errFixed,
+           nsPerCall([](int i){ return (float)adxl345_asinFixed((int32_t)(arg(i) * 16384), 16384); }));
+
+    errLibm = errFast = errFixed = 0;
+    for(int i=0; i<STEPS; i++){
+        float a = angleArg(i);
+        float y = 1000 * sinf(a);
+        float x = 1000 * cosf(a);
+        double ref = atan2((double)y, (double)x) * 180.0 / M_PI;
+        errLibm = fmax(errLibm, fabs(libmAtan2Deg(y, x) - ref));
+        errFast = fmax(errFast, fabs(adxl345_fastAtan2Deg(y, x) - ref));
+        double refInt = atan2((double)(int32_t)y, (double)(int32_t)x) * 180.0 / M_PI;
+        double diff = fabs(adxl345_atan2Fixed((int32_t)y, (int32_t)x) / 100.0 - refInt);
+        errFixed = fmax(errFixed, fmin(diff, 360.0 - diff));
+    }
+    printf("atan2,libm,%.5f,%.2f\n", errLibm,
+           nsPerCall([](int i){ return libmAtan2Deg(sinf(angleArg(i)), cosf(angleArg(i))); }));
+    printf("atan2,fast,%.5f,%.2f\n", errFast,
+           nsPerCall([](int i){ return adxl345_fastAtan2Deg(sinf(angleArg(i)), cosf(angleArg(i))); }));
+    printf("atan2,fixed,%.5f,%.2f\n", errFixed,
+           nsPerCall([](int i){ return (float)adxl345_atan2Fixed((int32_t)(1000 * sinf(angleArg(i))),
+                                                                 (int32_t)(1000 * cosf(angleArg(i)))); }));
+
+    const adxl345_trigMode modes[3] = {ADXL345_TRIG_LIBM, ADXL345_TRIG_FAST, ADXL345_TRIG_FIXED};
+    const char *modeNames[3] = {"libm", "fast", "fixed"};
+    static adxl345_trigMode mode;
+    for(int m=0; m<3; m++){
+        mode = modes[m];
+        printf("snapshot_angles,%s,,%.2f\n", modeNames[m],
+               nsPerCall([](int i){ return ADXL345_Snapshot(gArg(i), xyzFloat(), mode).getAngles().x; }));
+    }
+    bool ok = true;
+    for(int m=0; m<3; m++){
+        mode = modes[m];
+        double err = 0.0;
+        for(float length : {1.0f, 16.0f, 30.0f, 100.0f}){
+            err = fmax(err, pitchRollError(mode, length));
+        }
+        ok &= (err <= MAX_PITCH_ROLL_ERR);
+        printf("snapshot_pitch_roll,%s,%.5f,%.2f\n", modeNames[m], err,
+               nsPerCall([](int i){
+                   float pitch, roll;
+                   ADXL345_Snapshot(gArg(i), xyzFloat(), mode).getPitchRoll(&pitch, &roll);
+                   return pitch + roll;
+               }));
+    }
+    printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
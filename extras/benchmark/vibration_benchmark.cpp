@@ -0,0 +1,102 @@
+/******************************************************************************
+ *
+ * Host benchmark for ADXL345_Vibration. The simulated sensor vibrates with
+ * a sine on z (on top of gravity) and a smaller one at another frequency on
+ * x. The FIFO is drained and fed to the analysis. Reports the features of
+ * the last window, compares them with the expected values and the time per
+ * window. Returns 1 if a feature is outside of its tolerance.
+ *
+ * Build with CMakeLists.txt in this directory.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include "ADXL345_SimBus.h"
+#include "ADXL345_Vibration.h"
+
+static constexpr float SAMPLE_RATE   {3200.0};
+static constexpr uint16_t WINDOW     {1024};
+static constexpr uint16_t WINDOWS    {50};
+static constexpr float Z_HZ          {250.0};
+static constexpr float Z_AMP         {0.5};
+static constexpr float X_HZ          {800.0};
+static constexpr float X_AMP         {0.2};
+
+static float fftBuffer[WINDOW];
+static uint32_t callbackCount;
+
+static bool nextSample(void *context, xyzFloat *gVal){
+    uint32_t *sample = static_cast<uint32_t *>(context);
+    double t = *sample / SAMPLE_RATE;
+    gVal->x = X_AMP * sin(2 * M_PI * X_HZ * t);
+    gVal->y = 0.0;
+    gVal->z = 1.0 + Z_AMP * sin(2 * M_PI * Z_HZ * t);
+    (*sample)++;
+    return true;
+}
+
+static void onWindow(void *context, const adxl345_vibFeatures &features){
+    (void)context;
+    (void)features;
+    callbackCount++;
+}
+
+static bool within(float val, float expected, float tol){
+    return fabs(val - expected) <= tol;
+}
+
+int main(){
+    ADXL345_SimBus sim;
+    ADXL345_WE acc(&sim);
+    acc.init();
+    acc.setDataRate(ADXL345_DATA_RATE_3200);
+    acc.setRange(ADXL345_RANGE_4G);
+    acc.setFullRes(true);
+    uint32_t sample = 0;
+    sim.setSampleSource(nextSample, &sample);
+    acc.setFifoMode(ADXL345_STREAM);
+
+    ADXL345_Vibration vibZ(&acc, fftBuffer, WINDOW);
+    vibZ.begin(SAMPLE_RATE, ADXL345_VIB_Z);
+    vibZ.setCallback(onWindow);
+    xyzInt16 buf[32];
+    double ns = 0.0;
+    while(callbackCount < WINDOWS){
+        sim.generateSamples(32);
+        uint8_t n = acc.readFifo(buf, 32);
+        auto start = std::chrono::steady_clock::now();
+        vibZ.addSamples(buf, n);
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    adxl345_vibFeatures f;
+    vibZ.getFeatures(&f);
+
+    /* Resolution 3.9 mg: the quantization adds a little to RMS and peak */
+    const float rmsZ = Z_AMP / sqrt(2.0), rmsX = X_AMP / sqrt(2.0);
+    float bandSum = 0.0;
+    for(uint8_t b=0; b<f.bands; b++){
+        bandSum += f.bandRms[b] * f.bandRms[b];
+    }
+    bool ok = within(f.rms.z, rmsZ, 0.005) && within(f.rms.x, rmsX, 0.005) && within(f.rms.y, 0.0, 0.005)
+           && within(f.peak.z, Z_AMP, 0.01) && within(f.crest.z, sqrt(2.0), 0.03)
+           && within(f.dominantHz, Z_HZ, vibZ.getBinHz()) && within(f.dominantAmp, Z_AMP, 0.01)
+           && within(f.bandRms[1], rmsZ, 0.005) && within(sqrt(bandSum), rmsZ, 0.005);
+
+    printf("windows,window_size,bin_hz,ns_per_window,ns_per_sample\n");
+    printf("%u,%u,%.3f,%.0f,%.2f\n", (unsigned)callbackCount, WINDOW, vibZ.getBinHz(), ns / callbackCount,
+           ns / (static_cast<double>(callbackCount) * WINDOW));
+    printf("rms,%.4f,%.4f,%.4f\npeak,%.4f,%.4f,%.4f\ncrest,%.3f,%.3f,%.3f\n", f.rms.x, f.rms.y, f.rms.z,
+           f.peak.x, f.peak.y, f.peak.z, f.crest.x, f.crest.y, f.crest.z);
+    printf("dominant_hz,%.2f\ndominant_amp,%.4f\nband_rms", f.dominantHz, f.dominantAmp);
+    for(uint8_t b=0; b<f.bands; b++){
+        printf(",%.4f", f.bandRms[b]);
+    }
+    printf("\nfeatures_ok,%s\n", ok ? "yes" : "NO");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/********************************************************************
+* Interrupt driven continuous acquisition for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Acquisition.h"
+
+static constexpr uint8_t FIFO_DEPTH {32};
+
+/* Sets up the FIFO in stream mode with the watermark interrupt on intPin. The overrun
+   interrupt is only enabled on the ADXL345 side, so that it is counted. */
+bool ADXL345_Acquisition::begin(uint8_t intPin, uint8_t watermark){
+    if(ringSize < 2 || watermark < 1 || watermark > 32){
+        return false;
+    }
+    head = 0;
+    tail = 0;
+    pending = false;
+    resetCounters();
+    bool ok = myAcc->setFifoMode(ADXL345_BYPASS);
+    ok &= myAcc->setFifoParameters(ADXL345_TRIGGER_INT_1, watermark);
+    ok &= myAcc->setInterrupt(ADXL345_WATERMARK, intPin);
+    ok &= myAcc->setFifoMode(ADXL345_STREAM);
+    myAcc->readAndClearInterrupts();
+    return ok;
+}
+
+bool ADXL345_Acquisition::end(){
+    pending = false;
+    return myAcc->deleteInterrupt(ADXL345_WATERMARK) && myAcc->setFifoMode(ADXL345_BYPASS);
+}
+
+/* Drains the FIFO into the ring buffer if an interrupt was signaled (or force is true).
+   Note that reading INT_SOURCE also clears other interrupt flags. Returns the number of
+   samples stored. */
+uint16_t ADXL345_Acquisition::service(bool force){
+    if(!pending && !force){
+        return 0;
+    }
+    pending = false;
+    uint8_t intSource = myAcc->readAndClearInterrupts();
+    if(myAcc->checkInterrupt(intSource, ADXL345_OVERRUN)){
+        overruns++;
+    }
+    uint16_t stored = 0;
+    uint16_t h = head;
+    bool ringFull = false;
+    for(int pass=0; pass<2; pass++){
+        uint16_t t = loadIndex(tail);
+        uint16_t space = (t > h) ? (t - h - 1) : (ringSize - h - (t == 0 ? 1 : 0));
+        if(space > 255){
+            space = 255;
+        }
+        if(space == 0){
+            ringFull = true;
+            break;
+        }
+        uint8_t n = myAcc->readFifo(&ring[h], space);
+        h = (h + n) % ringSize;
+        stored += n;
+        storeIndex(head, h);
+        if(n < space){
+            break; // FIFO is empty
+        }
+    }
+    if(ringFull){
+        // Discard what is left in the FIFO to keep the ADXL345 running. Not more than one FIFO 
+        // depth: with a high data rate and a slow bus, new samples arrive as fast as they are read.
+        xyzInt16 scratch[8];
+        uint8_t left = FIFO_DEPTH;
+        uint8_t n = 0;
+        while(left > 0 && (n = myAcc->readFifo(scratch, (left < 8) ? left : 8)) > 0){
+            dropped += n;
+            left -= n;
+        }
+    }
+    samplesAcquired += stored;
+    return stored;
+}
+
+uint16_t ADXL345_Acquisition::available(){
+    uint16_t h = loadIndex(head);
+    uint16_t t = tail;
+    return (h >= t) ? (h - t) : (ringSize - t + h);
+}
+
+bool ADXL345_Acquisition::read(xyzInt16 *sample){
+    return read(sample, 1) == 1;
+}
+
+uint16_t ADXL345_Acquisition::read(xyzInt16 *buf, uint16_t maxSamples){
+    uint16_t h = loadIndex(head);
+    uint16_t t = tail;
+    uint16_t count = 0;
+    while(t != h && count < maxSamples){
+        buf[count++] = ring[t];
+        t = (t + 1) % ringSize;
+    }
+    storeIndex(tail, t);
+    return count;
+}
+
+void ADXL345_Acquisition::resetCounters(){
+    samplesAcquired = 0;
+    dropped = 0;
+    overruns = 0;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+/* 16 bit accesses are not atomic on AVR, so interrupts are blocked for the access. Elsewhere
+   a memory barrier ensures that the sample data is visible before the index. */
+uint16_t ADXL345_Acquisition::loadIndex(volatile uint16_t &index){
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t val = index;
+    SREG = oldSREG;
+    return val;
+#else
+    uint16_t val = index;
+    __sync_synchronize();
+    return val;
+#endif
+}
+
+void ADXL345_Acquisition::storeIndex(volatile uint16_t &index, uint16_t val){
+#ifdef __AVR__
+    uint8_t oldSREG = SREG;
+    cli();
+    index = val;
+    SREG = oldSREG;
+#else
+    __sync_synchronize();
+    index = val;
+#endif
+}
+
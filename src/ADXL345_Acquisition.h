@@ -0,0 +1,61 @@
+/******************************************************************************
+ *
+ * Interrupt driven continuous acquisition for the ADXL345_WE library.
+ *
+ * ADXL345_Acquisition runs the FIFO in stream mode with the watermark
+ * interrupt. Call onInterrupt() from your ISR and service() from loop()
+ * (or a task). service() drains the FIFO into a ring buffer which you
+ * provide. The application takes the samples with read() at its own pace.
+ * service() is the only producer and read() the only consumer, so they may
+ * run in different contexts without locking.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_ACQUISITION_H_
+#define ADXL345_ACQUISITION_H_
+
+#include "ADXL345_WE.h"
+
+class ADXL345_Acquisition
+{
+    public:
+        /* ringBuf holds ringSize samples, one slot is kept free to distinguish full from empty */
+        ADXL345_Acquisition(ADXL345_WE *acc, xyzInt16 *ringBuf, uint16_t ringSize)
+            : myAcc{acc}, ring{ringBuf}, ringSize{ringSize} {}
+
+        bool begin(uint8_t intPin = INT_PIN_1, uint8_t watermark = 16);
+        bool end();
+        void onInterrupt() { pending = true; myAcc->markWatermark(); }
+        uint16_t service(bool force = false);
+
+        /* Consumer side */
+        uint16_t available();
+        bool read(xyzInt16 *sample);
+        uint16_t read(xyzInt16 *buf, uint16_t maxSamples);
+
+        /* Counters */
+        uint32_t getSamplesAcquired() { return samplesAcquired; }
+        uint32_t getDropped() { return dropped; }      // lost because the ring buffer was full
+        uint32_t getOverruns() { return overruns; }    // FIFO overruns reported by the ADXL345
+        void resetCounters();
+
+    protected:
+        ADXL345_WE *myAcc;
+        xyzInt16 *ring;
+        uint16_t ringSize;
+        volatile uint16_t head = 0;   // written by the producer only
+        volatile uint16_t tail = 0;   // written by the consumer only
+        volatile bool pending = false;
+        uint32_t samplesAcquired = 0;
+        uint32_t dropped = 0;
+        uint32_t overruns = 0;
+        uint16_t loadIndex(volatile uint16_t &index);
+        void storeIndex(volatile uint16_t &index, uint16_t val);
+};
+
+#endif
+
@@ -0,0 +1,125 @@
+/********************************************************************
+* Non-blocking register and FIFO reads for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Async.h"
+
+bool ADXL345_Async::startRead(uint8_t reg, uint8_t *buf, uint8_t count, 
+                              adxl345_asyncCallback cb, void *context){
+    if(isBusy() || count == 0){
+        return false;
+    }
+    this->reg = reg;
+    dest = buf;
+    total = count;
+    done = 0;
+    callback = cb;
+    cbContext = context;
+    step = STEP_REGISTERS;
+    return true;
+}
+
+/* Reads FIFO_STATUS first and then up to maxSamples entries, one transaction per entry */
+bool ADXL345_Async::startReadFifo(xyzInt16 *rawBuf, uint8_t maxSamples, 
+                                  adxl345_asyncCallback cb, void *context){
+    if(isBusy() || maxSamples == 0){
+        return false;
+    }
+    fifoBuf = rawBuf;
+    total = maxSamples;
+    done = 0;
+    callback = cb;
+    cbContext = context;
+    step = STEP_FIFO_STATUS;
+    return true;
+}
+
+/* Returns ADXL345_ASYNC_DONE once when the read is complete (after the callback), 
+   ADXL345_ASYNC_BUSY while it is running and ADXL345_ASYNC_IDLE if nothing was started. */
+adxl345_asyncState ADXL345_Async::poll(){
+    switch(step){
+        case STEP_IDLE:
+            return ADXL345_ASYNC_IDLE;
+
+        case STEP_REGISTERS:
+            if(!transfer(dest, total)){
+                return inFlight ? ADXL345_ASYNC_BUSY : finish(false);
+            }
+            done = total;
+            return finish(true);
+
+        case STEP_FIFO_STATUS:
+            if(!transfer(&status, 1)){
+                return inFlight ? ADXL345_ASYNC_BUSY : finish(false);
+            }
+            if((status & ADXL345_WE::ADXL345_FIFO_ENTRIES) < total){
+                total = status & ADXL345_WE::ADXL345_FIFO_ENTRIES;
+            }
+            if(total == 0){
+                return finish(true);
+            }
+            step = STEP_FIFO_DATA;
+            return ADXL345_ASYNC_BUSY;
+
+        case STEP_FIFO_DATA:{
+            uint8_t *entry = reinterpret_cast<uint8_t*>(&fifoBuf[done]);
+            if(!transfer(entry, ADXL345_Bus::ADXL345_FIFO_ENTRY_SIZE)){
+                return inFlight ? ADXL345_ASYNC_BUSY : finish(false);
+            }
+            ADXL345_WE::rawToXyz(entry, &fifoBuf[done]);
+            myAcc->statsDrained(1);
+            done++;
+            return (done < total) ? ADXL345_ASYNC_BUSY : finish(true);
+        }
+    }
+    return ADXL345_ASYNC_ERROR; // Not possible, but avoids compiler warning
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+/* Returns true when the data of the current step is in buf. While a non-blocking transfer
+   is in flight it returns false with inFlight set. */
+bool ADXL345_Async::transfer(uint8_t *buf, uint8_t count){
+    ADXL345_Bus *bus = myAcc->activeBus();
+    uint8_t startReg = (step == STEP_REGISTERS) ? reg : 
+                       (step == STEP_FIFO_STATUS) ? ADXL345_WE::ADXL345_FIFO_STATUS :
+                       ADXL345_Bus::ADXL345_FIFO_DATA_REG;
+    if(inFlight){
+        if(!bus->isTransferDone()){
+            return false;
+        }
+        inFlight = false;
+        myAcc->statsBus(startMicros, 1, count + 1, true);
+        return true;
+    }
+    startMicros = myAcc->statsStart();
+    if(bus->startReadRegisters(startReg, buf, count)){
+        inFlight = !bus->isTransferDone();
+        if(!inFlight){
+            myAcc->statsBus(startMicros, 1, count + 1, true);
+        }
+        return !inFlight;
+    }
+    bool ok = bus->readRegisters(startReg, buf, count);
+    myAcc->statsBus(startMicros, 1, count + 1, ok);
+    return ok;
+}
+
+adxl345_asyncState ADXL345_Async::finish(bool ok){
+    step = STEP_IDLE;
+    inFlight = false;
+    if(!ok){
+        return ADXL345_ASYNC_ERROR;
+    }
+    if(callback){
+        callback(cbContext, done);
+    }
+    return ADXL345_ASYNC_DONE;
+}
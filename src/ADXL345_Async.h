@@ -0,0 +1,66 @@
+/******************************************************************************
+ *
+ * Non-blocking register and FIFO reads for the ADXL345_WE library.
+ *
+ * ADXL345_Async splits a read into steps. Start it with startRead() or
+ * startReadFifo() and call poll() regularly, e.g. once per loop(). If the
+ * transport offers non-blocking transfers (ADXL345_Bus::startReadRegisters),
+ * the CPU is free while the data is on the bus. Otherwise each poll() does
+ * one blocking step (FIFO_STATUS or one FIFO entry of 6 bytes), so that the
+ * time spent per call stays short. The callback, if set, is called from
+ * poll() when the read is complete.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_ASYNC_H_
+#define ADXL345_ASYNC_H_
+
+#include "ADXL345_WE.h"
+
+typedef enum ADXL345_ASYNC_STATE {
+    ADXL345_ASYNC_IDLE, ADXL345_ASYNC_BUSY, ADXL345_ASYNC_DONE, ADXL345_ASYNC_ERROR,
+    ADXL343_ASYNC_IDLE  = ADXL345_ASYNC_IDLE,
+    ADXL343_ASYNC_BUSY  = ADXL345_ASYNC_BUSY,
+    ADXL343_ASYNC_DONE  = ADXL345_ASYNC_DONE,
+    ADXL343_ASYNC_ERROR = ADXL345_ASYNC_ERROR
+} adxl345_asyncState;
+
+/* count is the number of bytes (startRead) or FIFO entries (startReadFifo) delivered */
+typedef void (*adxl345_asyncCallback)(void *context, uint8_t count);
+
+class ADXL345_Async
+{
+    public:
+        ADXL345_Async(ADXL345_WE *acc) : myAcc{acc} {}
+
+        bool startRead(uint8_t reg, uint8_t *buf, uint8_t count, 
+                       adxl345_asyncCallback cb = nullptr, void *context = nullptr);
+        bool startReadFifo(xyzInt16 *rawBuf, uint8_t maxSamples, 
+                           adxl345_asyncCallback cb = nullptr, void *context = nullptr);
+        adxl345_asyncState poll();
+        bool isBusy() { return step != STEP_IDLE; }
+        uint8_t getCount() { return done; }
+
+    protected:
+        enum asyncStep : uint8_t { STEP_IDLE, STEP_REGISTERS, STEP_FIFO_STATUS, STEP_FIFO_DATA };
+        ADXL345_WE *myAcc;
+        asyncStep step = STEP_IDLE;
+        bool inFlight = false;
+        uint8_t reg = 0;
+        uint8_t *dest = nullptr;
+        xyzInt16 *fifoBuf = nullptr;
+        uint8_t total = 0;
+        uint8_t done = 0;
+        uint8_t status = 0;
+        uint32_t startMicros = 0;
+        adxl345_asyncCallback callback = nullptr;
+        void *cbContext = nullptr;
+        bool transfer(uint8_t *buf, uint8_t count);
+        adxl345_asyncState finish(bool ok);
+};
+
+#endif
@@ -0,0 +1,216 @@
+/********************************************************************
+* Online calibration for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include "ADXL345_AutoCal.h"
+
+static constexpr float DEFAULT_STD_DEV   {0.01};  // g
+static constexpr float MAX_NORM_DEV      {0.25};  // a still block has to be 1 g +/- this
+static constexpr float MAX_OFFSET        {0.5};   // g, plausibility limits of the result
+static constexpr float MIN_CORR          {0.8};
+static constexpr float MAX_CORR          {1.25};
+static constexpr float MIN_PIVOT         {1e-4};  // relative to the largest diagonal element
+
+void ADXL345_AutoCal::reset(){
+    maxVar = DEFAULT_STD_DEV * DEFAULT_STD_DEV;
+    blockCount = 0;
+    for(uint8_t i=0; i<ADXL345_AC_PARAMS * (ADXL345_AC_PARAMS + 1) / 2; i++){
+        normal[i] = 0.0;
+    }
+    for(uint8_t i=0; i<ADXL345_AC_PARAMS; i++){
+        rhs[i] = 0.0;
+    }
+    havePose = false;
+    poses = 0;
+    updates = 0;
+    rejected = 0;
+    calibrated = false;
+}
+
+void ADXL345_AutoCal::setStillness(uint8_t size, float maxStdDev){
+    blockSize = (size < 2) ? 2 : size;
+    maxVar = maxStdDev * maxStdDev;
+    blockCount = 0;
+}
+
+bool ADXL345_AutoCal::addSample(const xyzInt16 &rawVal){
+    const int16_t val[3] = {rawVal.x, rawVal.y, rawVal.z};
+    if(blockCount == 0){
+        for(int i=0; i<3; i++){
+            ref[i] = val[i];
+            sum[i] = 0;
+            sumSq[i] = 0.0;
+        }
+    }
+    for(int i=0; i<3; i++){
+        int32_t d = static_cast<int32_t>(val[i]) - ref[i];
+        sum[i] += d;
+        sumSq[i] += static_cast<float>(d) * d;
+    }
+    if(++blockCount < blockSize){
+        return false;
+    }
+    blockCount = 0;
+    uint16_t before = updates;
+    finishBlock();
+    return updates != before;
+}
+
+bool ADXL345_AutoCal::addSamples(const xyzInt16 *rawVal, uint16_t n){
+    bool updated = false;
+    for(uint16_t i=0; i<n; i++){
+        updated |= addSample(rawVal[i]);
+    }
+    return updated;
+}
+
+bool ADXL345_AutoCal::getCalibration(xyzFloat *offset, xyzFloat *corr){
+    if(!calibrated){
+        return false;
+    }
+    *offset = offsetVal;
+    *corr = corrFact;
+    return true;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+void ADXL345_AutoCal::finishBlock(){
+    const float gPerLsb = adxl->getRangeFactor() / ADXL345_WE::UNITS_PER_G;
+    const float maxVarRaw = maxVar / (gPerLsb * gPerLsb);
+    const float gPerOfsLsb = ADXL345_WE::MILLI_G_PER_OFS_LSB / 1000.0;
+    const xyzInt16 hw = adxl->getHardwareOffsets();
+    const int16_t ofs[3] = {hw.x, hw.y, hw.z};
+    float mean[3];
+    for(int i=0; i<3; i++){
+        float m = static_cast<float>(sum[i]) / blockSize;
+        if(sumSq[i] / blockSize - m * m > maxVarRaw){
+            return;     // moving
+        }
+        mean[i] = (ref[i] + m) * gPerLsb - ofs[i] * gPerOfsLsb;  // undo OFSX-Z, the fit needs the full offset
+    }
+    xyzFloat pose(mean[0], mean[1], mean[2]);
+    float norm = sqrt(pose.x * pose.x + pose.y * pose.y + pose.z * pose.z);
+    if(norm < 1.0 - MAX_NORM_DEV || norm > 1.0 + MAX_NORM_DEV){
+        return;     // still, but not only gravity
+    }
+    if(havePose){
+        xyzFloat d = pose - lastPose;
+        if(d.x * d.x + d.y * d.y + d.z * d.z < minPoseDist * minPoseDist){
+            return;     // same pose as before
+        }
+    }
+    lastPose = pose;
+    havePose = true;
+    addPose(pose);
+}
+
+void ADXL345_AutoCal::addPose(const xyzFloat &g){
+    const float phi[ADXL345_AC_PARAMS] = {g.x * g.x, g.y * g.y, g.z * g.z, g.x, g.y, g.z};
+    uint8_t k = 0;
+    for(uint8_t i=0; i<ADXL345_AC_PARAMS; i++){
+        for(uint8_t j=i; j<ADXL345_AC_PARAMS; j++){
+            normal[k] = forgetting * normal[k] + phi[i] * phi[j];
+            k++;
+        }
+        rhs[i] = forgetting * rhs[i] + phi[i];
+    }
+    if(poses < 0xFFFF){
+        poses++;
+    }
+    if(poses < ADXL345_AC_MIN_POSES){
+        return;
+    }
+    if(!solve()){
+        rejected++;
+        return;
+    }
+    updates++;
+    calibrated = true;
+    if(autoApply){
+        adxl->setCalibration(offsetVal, corrFact);
+    }
+}
+
+/* Gaussian elimination with partial pivoting on a copy of the normal equations. A small pivot
+   means that the poses don't cover enough directions yet. */
+bool ADXL345_AutoCal::solve(){
+    const uint8_t n = ADXL345_AC_PARAMS;
+    float m[ADXL345_AC_PARAMS][ADXL345_AC_PARAMS + 1];
+    uint8_t k = 0;
+    float maxDiag = 0.0;
+    for(uint8_t i=0; i<n; i++){
+        for(uint8_t j=i; j<n; j++){
+            m[i][j] = normal[k];
+            m[j][i] = normal[k];
+            k++;
+        }
+        m[i][n] = rhs[i];
+        if(m[i][i] > maxDiag){
+            maxDiag = m[i][i];
+        }
+    }
+    for(uint8_t col=0; col<n; col++){
+        uint8_t pivot = col;
+        for(uint8_t row=col+1; row<n; row++){
+            if(fabs(m[row][col]) > fabs(m[pivot][col])){
+                pivot = row;
+            }
+        }
+        if(fabs(m[pivot][col]) < MIN_PIVOT * maxDiag){
+            return false;
+        }
+        if(pivot != col){
+            for(uint8_t j=col; j<=n; j++){
+                float tmp = m[col][j];
+                m[col][j] = m[pivot][j];
+                m[pivot][j] = tmp;
+            }
+        }
+        for(uint8_t row=col+1; row<n; row++){
+            float f = m[row][col] / m[col][col];
+            for(uint8_t j=col; j<=n; j++){
+                m[row][j] -= f * m[col][j];
+            }
+        }
+    }
+    float p[ADXL345_AC_PARAMS];
+    for(int8_t i=n-1; i>=0; i--){
+        float s = m[i][n];
+        for(uint8_t j=i+1; j<n; j++){
+            s -= m[i][j] * p[j];
+        }
+        p[i] = s / m[i][i];
+    }
+
+    /* A*(x-ox)^2 + B*(y-oy)^2 + C*(z-oz)^2 = G, the semi-axes are sqrt(G/A) ... */
+    if(p[0] <= 0.0 || p[1] <= 0.0 || p[2] <= 0.0){
+        return false;
+    }
+    float o[3], corr[3];
+    float g = 1.0;
+    for(int i=0; i<3; i++){
+        o[i] = -p[i+3] / (2.0 * p[i]);
+        g += p[i] * o[i] * o[i];
+    }
+    if(g <= 0.0){
+        return false;
+    }
+    for(int i=0; i<3; i++){
+        corr[i] = sqrt(p[i] / g);
+        if(fabs(o[i]) > MAX_OFFSET || corr[i] < MIN_CORR || corr[i] > MAX_CORR){
+            return false;
+        }
+    }
+    offsetVal = xyzFloat(o[0], o[1], o[2]) * ADXL345_WE::UNITS_PER_G;
+    corrFact = xyzFloat(corr[0], corr[1], corr[2]);
+    return true;
+}
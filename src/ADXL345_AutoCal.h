@@ -0,0 +1,98 @@
+/******************************************************************************
+ *
+ * Online calibration for the ADXL345_WE library.
+ *
+ * ADXL345_AutoCal consumes the raw samples of a running acquisition (e.g.
+ * from readFifo()) and estimates the offset and the gain of each axis
+ * while the application keeps measuring. The samples are split into blocks.
+ * A block in which no axis varies more than the stillness threshold is a
+ * quasi-static pose, i.e. the sensor only sees gravity. Each new pose
+ * (differing from the previous one) is added to a least squares fit of an
+ * axis aligned ellipsoid
+ *
+ *      A*x^2 + B*y^2 + C*z^2 + D*x + E*y + F*z = 1
+ *
+ * Only the normal equations are stored, so memory does not grow with the
+ * number of poses. Older poses are weighted down by a forgetting factor to
+ * follow slow drifts (e.g. temperature). As soon as the fit is well
+ * conditioned (about six poses in different directions, like the six
+ * position calibration in ADXL345_calibration.ino) and plausible, the
+ * result is passed to setCalibration() of the ADXL345_WE object. If the
+ * offsets are corrected in OFSX-Z (enableHardwareOffsets()), the current
+ * register values are added back to the samples, so that the fit always
+ * yields the complete offset.
+ *
+ * The cost per sample is a few additions and multiplications. The fit is
+ * only solved when a new pose is accepted. Call addSample() / addSamples()
+ * from the same context in which you read the values, because the scaling
+ * of the ADXL345_WE object changes when a result is applied.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_AUTOCAL_H_
+#define ADXL345_AUTOCAL_H_
+
+#include "ADXL345_WE.h"
+
+class ADXL345_AutoCal
+{
+    public:
+        static constexpr uint8_t ADXL345_AC_PARAMS   {6};    // A ... F
+        static constexpr uint8_t ADXL345_AC_MIN_POSES {6};
+
+        ADXL345_AutoCal(ADXL345_WE *acc) : adxl{acc} { reset(); }
+
+        void reset();
+        /* blockSize: samples per stillness check, maxStdDev: max. standard deviation per axis in g */
+        void setStillness(uint8_t blockSize, float maxStdDev);
+        /* Min. distance in g between two successive poses */
+        void setMinPoseDistance(float dist) { minPoseDist = dist; }
+        /* Weight of the previous poses when a new one is added, 0 < lambda <= 1 (1 = no forgetting) */
+        void setForgetting(float lambda) { forgetting = lambda; }
+        /* If false, get the result with getCalibration() and apply it yourself */
+        void setAutoApply(bool apply) { autoApply = apply; }
+
+        /* Return true if a new calibration was computed */
+        bool addSample(const xyzInt16 &rawVal);
+        bool addSamples(const xyzInt16 *rawVal, uint16_t n);
+
+        /* offset in units of ADXL345_WE::setCorrFactors() (like offsetVal), corr = correction factors */
+        bool getCalibration(xyzFloat *offset, xyzFloat *corr);
+        bool isCalibrated() { return calibrated; }
+        uint16_t getPoseCount() { return poses; }
+        uint16_t getUpdateCount() { return updates; }
+        uint16_t getRejectedFits() { return rejected; }
+
+    protected:
+        ADXL345_WE *adxl;
+        uint8_t blockSize = 32;
+        float maxVar;               // in g^2
+        float minPoseDist = 0.25;
+        float forgetting = 0.95;
+        bool autoApply = true;
+        /* current block */
+        uint8_t blockCount;
+        int16_t ref[3];             // first sample of the block, keeps the sums small
+        int32_t sum[3];
+        float sumSq[3];
+        /* fit */
+        float normal[ADXL345_AC_PARAMS * (ADXL345_AC_PARAMS + 1) / 2]; // upper triangle, row by row
+        float rhs[ADXL345_AC_PARAMS];
+        xyzFloat lastPose;          // in g, uncorrected
+        bool havePose;
+        uint16_t poses;
+        uint16_t updates;
+        uint16_t rejected;
+        bool calibrated;
+        xyzFloat offsetVal;
+        xyzFloat corrFact;
+        void finishBlock();
+        void addPose(const xyzFloat &g);
+        bool solve();
+};
+
+#endif
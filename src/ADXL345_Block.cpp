@@ -0,0 +1,264 @@
+/********************************************************************
+* Block conversion kernels for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "ADXL345_Block.h"
+
+#if !defined(ADXL345_NO_SIMD)
+ #if defined(__AVX2__)
+  #define ADXL345_SIMD_AVX2
+  #define ADXL345_SIMD_SSE2
+  #include <immintrin.h>
+ #elif defined(__SSE2__) || defined(_M_X64)
+  #define ADXL345_SIMD_SSE2
+  #include <emmintrin.h>
+ #elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  #define ADXL345_SIMD_NEON
+  #include <arm_neon.h>
+ #endif
+#endif
+
+static_assert(sizeof(xyzInt16) == 6, "xyzInt16 has to be packed");
+static_assert(sizeof(xyzFloat) == 12, "xyzFloat has to be packed");
+
+/* asin(x) = pi/2 - sqrt(1 - x) * (a0 + a1*x + a2*x^2 + a3*x^3), like adxl345_fastAsinDeg(),
+   but only with float operations in a fixed order */
+static constexpr float ASIN_A0     {1.5707288f};
+static constexpr float ASIN_A1     {-0.2121144f};
+static constexpr float ASIN_A2     {0.0742610f};
+static constexpr float ASIN_A3     {-0.0187293f};
+static constexpr float HALF_PI_F   {1.5707963f};
+static constexpr float DEG_PER_RAD {57.295780f};
+
+void adxl345_bytesToRaw(const uint8_t *bytes, xyzInt16 *rawVal, uint16_t n){
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* Same layout, nothing to do in place */
+    if(reinterpret_cast<const uint8_t *>(rawVal) != bytes){
+        memmove(rawVal, bytes, n * sizeof(xyzInt16));
+    }
+#else
+    for(uint16_t i=0; i<n; i++){
+        const uint8_t *b = bytes + 6*i;
+        int16_t x = static_cast<int16_t>((b[1] << 8) | b[0]);
+        int16_t y = static_cast<int16_t>((b[3] << 8) | b[2]);
+        int16_t z = static_cast<int16_t>((b[5] << 8) | b[4]);
+        rawVal[i] = xyzInt16(x, y, z);
+    }
+#endif
+}
+
+void adxl345_rawToGScalar(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                          xyzFloat *gVal, uint16_t n){
+    const xyzFloat off = offset;
+    const xyzFloat fac = factor;
+    for(uint16_t i=0; i<n; i++){
+        gVal[i].x = (rawVal[i].x - off.x) * fac.x;
+        gVal[i].y = (rawVal[i].y - off.y) * fac.y;
+        gVal[i].z = (rawVal[i].z - off.z) * fac.z;
+    }
+}
+
+void adxl345_rawToGSoAScalar(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                             float *gX, float *gY, float *gZ, uint16_t n){
+    const xyzFloat off = offset;
+    const xyzFloat fac = factor;
+    for(uint16_t i=0; i<n; i++){
+        gX[i] = (rawVal[i].x - off.x) * fac.x;
+        gY[i] = (rawVal[i].y - off.y) * fac.y;
+        gZ[i] = (rawVal[i].z - off.z) * fac.z;
+    }
+}
+
+void adxl345_asinDegBlockScalar(const float *val, float *deg, uint16_t n){
+    for(uint16_t i=0; i<n; i++){
+        float v = val[i];
+        float a = fabsf(v);
+        a = (a < 1.0f) ? a : 1.0f;
+        float poly = ASIN_A3 * a;
+        poly = ASIN_A2 + poly;
+        poly = a * poly;
+        poly = ASIN_A1 + poly;
+        poly = a * poly;
+        poly = ASIN_A0 + poly;
+        float root = sqrtf(1.0f - a);
+        float result = (HALF_PI_F - root * poly) * DEG_PER_RAD;
+        deg[i] = (v < 0.0f) ? -result : result;
+    }
+}
+
+#if defined(ADXL345_SIMD_SSE2)
+
+/* Four samples are 12 values = 3 vectors, with the axes in the order x y z x | y z x y | z x y z */
+static inline void loadRaw4(const xyzInt16 *rawVal, __m128 *f0, __m128 *f1, __m128 *f2){
+    const int16_t *src = &rawVal->x;
+    __m128i v01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i v2 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + 8));
+    *f0 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v01, v01), 16));
+    *f1 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v01, v01), 16));
+    *f2 = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v2, v2), 16));
+}
+
+/* No SIMD version: the compiler vectorizes the scalar loop for AoS output at least as well */
+void adxl345_rawToG(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor, xyzFloat *gVal,
+                    uint16_t n){
+    adxl345_rawToGScalar(rawVal, offset, factor, gVal, n);
+}
+
+void adxl345_rawToGSoA(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                       float *gX, float *gY, float *gZ, uint16_t n){
+#if defined(ADXL345_SIMD_AVX2)
+    adxl345_rawToGSoAScalar(rawVal, offset, factor, gX, gY, gZ, n);     // vectorized better by the compiler
+#else
+    const __m128 offX = _mm_set1_ps(offset.x), offY = _mm_set1_ps(offset.y), offZ = _mm_set1_ps(offset.z);
+    const __m128 facX = _mm_set1_ps(factor.x), facY = _mm_set1_ps(factor.y), facZ = _mm_set1_ps(factor.z);
+    uint16_t i = 0;
+    for(; i+4<=n; i+=4){
+        __m128 a, b, c;    // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+        loadRaw4(&rawVal[i], &a, &b, &c);
+        __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+        __m128 x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+        __m128 t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+        __m128 y = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+        t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+        t1 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+        __m128 z = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+        _mm_storeu_ps(gX + i, _mm_mul_ps(_mm_sub_ps(x, offX), facX));
+        _mm_storeu_ps(gY + i, _mm_mul_ps(_mm_sub_ps(y, offY), facY));
+        _mm_storeu_ps(gZ + i, _mm_mul_ps(_mm_sub_ps(z, offZ), facZ));
+    }
+    adxl345_rawToGSoAScalar(rawVal + i, offset, factor, gX + i, gY + i, gZ + i, n - i);
+#endif
+}
+
+void adxl345_asinDegBlock(const float *val, float *deg, uint16_t n){
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    uint16_t i = 0;
+    for(; i+4<=n; i+=4){
+        __m128 v = _mm_loadu_ps(val + i);
+        __m128 a = _mm_min_ps(_mm_andnot_ps(signBit, v), one);
+        __m128 poly = _mm_mul_ps(_mm_set1_ps(ASIN_A3), a);
+        poly = _mm_add_ps(_mm_set1_ps(ASIN_A2), poly);
+        poly = _mm_mul_ps(a, poly);
+        poly = _mm_add_ps(_mm_set1_ps(ASIN_A1), poly);
+        poly = _mm_mul_ps(a, poly);
+        poly = _mm_add_ps(_mm_set1_ps(ASIN_A0), poly);
+        __m128 root = _mm_sqrt_ps(_mm_sub_ps(one, a));
+        __m128 result = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(HALF_PI_F), _mm_mul_ps(root, poly)),
+                                   _mm_set1_ps(DEG_PER_RAD));
+        __m128 negative = _mm_and_ps(_mm_cmplt_ps(v, zero), signBit);
+        _mm_storeu_ps(deg + i, _mm_xor_ps(result, negative));
+    }
+    adxl345_asinDegBlockScalar(val + i, deg + i, n - i);
+}
+
+/* Also with AVX2: the kernels above are SSE2, AVX2 only reaches the scalar loops via the compiler */
+const char* adxl345_blockSimd(){
+    return "SSE2";
+}
+
+#elif defined(ADXL345_SIMD_NEON)
+
+/* Not compiled or run on ARM so far, see ADXL345_Block.h */
+
+void adxl345_rawToG(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor, xyzFloat *gVal,
+                    uint16_t n){
+    const float offA[4] = {offset.x, offset.y, offset.z, offset.x};
+    const float offB[4] = {offset.y, offset.z, offset.x, offset.y};
+    const float offC[4] = {offset.z, offset.x, offset.y, offset.z};
+    const float facA[4] = {factor.x, factor.y, factor.z, factor.x};
+    const float facB[4] = {factor.y, factor.z, factor.x, factor.y};
+    const float facC[4] = {factor.z, factor.x, factor.y, factor.z};
+    const float32x4_t off0 = vld1q_f32(offA), off1 = vld1q_f32(offB), off2 = vld1q_f32(offC);
+    const float32x4_t fac0 = vld1q_f32(facA), fac1 = vld1q_f32(facB), fac2 = vld1q_f32(facC);
+    uint16_t i = 0;
+    for(; i+4<=n; i+=4){
+        const int16_t *src = &rawVal[i].x;
+        int16x8_t v01 = vld1q_s16(src);
+        int16x4_t v2 = vld1_s16(src + 8);
+        float32x4_t a = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v01)));
+        float32x4_t b = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v01)));
+        float32x4_t c = vcvtq_f32_s32(vmovl_s16(v2));
+        float *dst = &gVal[i].x;
+        vst1q_f32(dst, vmulq_f32(vsubq_f32(a, off0), fac0));
+        vst1q_f32(dst + 4, vmulq_f32(vsubq_f32(b, off1), fac1));
+        vst1q_f32(dst + 8, vmulq_f32(vsubq_f32(c, off2), fac2));
+    }
+    adxl345_rawToGScalar(rawVal + i, offset, factor, gVal + i, n - i);
+}
+
+void adxl345_rawToGSoA(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                       float *gX, float *gY, float *gZ, uint16_t n){
+    const float32x4_t offX = vdupq_n_f32(offset.x), offY = vdupq_n_f32(offset.y), offZ = vdupq_n_f32(offset.z);
+    const float32x4_t facX = vdupq_n_f32(factor.x), facY = vdupq_n_f32(factor.y), facZ = vdupq_n_f32(factor.z);
+    uint16_t i = 0;
+    for(; i+4<=n; i+=4){
+        int16x4x3_t v = vld3_s16(&rawVal[i].x);   // deinterleaves x, y, z
+        float32x4_t x = vcvtq_f32_s32(vmovl_s16(v.val[0]));
+        float32x4_t y = vcvtq_f32_s32(vmovl_s16(v.val[1]));
+        float32x4_t z = vcvtq_f32_s32(vmovl_s16(v.val[2]));
+        vst1q_f32(gX + i, vmulq_f32(vsubq_f32(x, offX), facX));
+        vst1q_f32(gY + i, vmulq_f32(vsubq_f32(y, offY), facY));
+        vst1q_f32(gZ + i, vmulq_f32(vsubq_f32(z, offZ), facZ));
+    }
+    adxl345_rawToGSoAScalar(rawVal + i, offset, factor, gX + i, gY + i, gZ + i, n - i);
+}
+
+void adxl345_asinDegBlock(const float *val, float *deg, uint16_t n){
+    uint16_t i = 0;
+#if defined(__aarch64__)   // vsqrtq_f32 is not available on 32 bit ARM
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    for(; i+4<=n; i+=4){
+        float32x4_t v = vld1q_f32(val + i);
+        float32x4_t a = vabsq_f32(v);
+        a = vbslq_f32(vcltq_f32(a, one), a, one);
+        float32x4_t poly = vmulq_f32(vdupq_n_f32(ASIN_A3), a);
+        poly = vaddq_f32(vdupq_n_f32(ASIN_A2), poly);
+        poly = vmulq_f32(a, poly);
+        poly = vaddq_f32(vdupq_n_f32(ASIN_A1), poly);
+        poly = vmulq_f32(a, poly);
+        poly = vaddq_f32(vdupq_n_f32(ASIN_A0), poly);
+        float32x4_t root = vsqrtq_f32(vsubq_f32(one, a));
+        float32x4_t result = vmulq_f32(vsubq_f32(vdupq_n_f32(HALF_PI_F), vmulq_f32(root, poly)),
+                                       vdupq_n_f32(DEG_PER_RAD));
+        vst1q_f32(deg + i, vbslq_f32(vcltq_f32(v, zero), vnegq_f32(result), result));
+    }
+#endif
+    adxl345_asinDegBlockScalar(val + i, deg + i, n - i);
+}
+
+const char* adxl345_blockSimd(){
+    return "NEON";
+}
+
+#else
+
+void adxl345_rawToG(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor, xyzFloat *gVal,
+                    uint16_t n){
+    adxl345_rawToGScalar(rawVal, offset, factor, gVal, n);
+}
+
+void adxl345_rawToGSoA(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                       float *gX, float *gY, float *gZ, uint16_t n){
+    adxl345_rawToGSoAScalar(rawVal, offset, factor, gX, gY, gZ, n);
+}
+
+void adxl345_asinDegBlock(const float *val, float *deg, uint16_t n){
+    adxl345_asinDegBlockScalar(val, deg, n);
+}
+
+const char* adxl345_blockSimd(){
+    return "none";
+}
+
+#endif
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Block conversion kernels for the ADXL345_WE library.
+ *
+ * The kernels convert many samples in one call, e.g. the FIFO contents of
+ * several sensors on a host which collects the data. They use SIMD
+ * instructions if the compiler targets them (SSE2 or NEON) and a portable
+ * scalar implementation otherwise, e.g. on AVR, ESP32 or STM32. With AVX2,
+ * the kernels stay SSE2 or scalar, see below.
+ * Define ADXL345_NO_SIMD (see ADXL345_Options.h) to always use the scalar
+ * code. The ...Scalar() functions are the reference: the SIMD results are
+ * identical bit by bit, as long as the compiler does not contract
+ * multiplications and additions (-ffp-contract=off for FMA targets).
+ * extras/benchmark/block_benchmark.cpp checks this for SSE2 and AVX2 builds.
+ * The NEON kernels are unverified: they were neither compiled nor run on
+ * ARM so far. Define ADXL345_NO_SIMD there until block_benchmark passed.
+ *
+ *   adxl345_bytesToRaw      FIFO / data register bytes (little endian) to
+ *                           xyzInt16, can work in place
+ *   adxl345_rawToG          (raw - offset) * factor, xyzFloat output (AoS);
+ *                           SIMD only with NEON, on x86 the compiler
+ *                           vectorizes the scalar loop at least as well
+ *   adxl345_rawToGSoA       as above, separate x, y and z arrays (SoA);
+ *                           SSE2 or NEON, scalar with AVX2 for the same
+ *                           reason
+ *   adxl345_asinDegBlock    asin in degrees with the polynomial of
+ *                           ADXL345_TRIG_FAST, for angles from g values
+ *
+ * offset and factor are the values ADXL345_WE::rawToGValues() uses, see
+ * ADXL345_WE::getScaling().
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_BLOCK_H_
+#define ADXL345_BLOCK_H_
+
+#include <stdint.h>
+#include "ADXL345_Options.h"
+#include "xyzFloat.h"
+#include "xyzInt16.h"
+
+void adxl345_bytesToRaw(const uint8_t *bytes, xyzInt16 *rawVal, uint16_t n);
+void adxl345_rawToG(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor, xyzFloat *gVal,
+                    uint16_t n);
+void adxl345_rawToGSoA(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                       float *gX, float *gY, float *gZ, uint16_t n);
+void adxl345_asinDegBlock(const float *val, float *deg, uint16_t n);
+
+/* Reference implementations without SIMD */
+void adxl345_rawToGScalar(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                          xyzFloat *gVal, uint16_t n);
+void adxl345_rawToGSoAScalar(const xyzInt16 *rawVal, const xyzFloat &offset, const xyzFloat &factor,
+                             float *gX, float *gY, float *gZ, uint16_t n);
+void adxl345_asinDegBlockScalar(const float *val, float *deg, uint16_t n);
+
+/* The SIMD instructions the kernels use: "SSE2" (also in AVX2 builds), "NEON" or "none" */
+const char* adxl345_blockSimd();
+
+#endif
@@ -0,0 +1,162 @@
+/********************************************************************
+* Bus transports for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Bus.h"
+
+/************ ADXL345_Bus ************/
+
+uint8_t ADXL345_Bus::readFifoEntries(uint8_t *buf, uint8_t entries){
+    uint8_t delivered = 0;
+    for(delivered=0; delivered<entries; delivered++){
+        if (!readRegisters(ADXL345_FIFO_DATA_REG, buf + delivered * ADXL345_FIFO_ENTRY_SIZE, ADXL345_FIFO_ENTRY_SIZE)) {
+            break;
+        }
+    }
+    return delivered;
+}
+
+/************ ADXL345_I2CBus ************/
+
+bool ADXL345_I2CBus::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count){
+    _wire->beginTransmission(i2cAddress);
+    _wire->write(reg);
+    for(int i=0; i<count; i++){
+        _wire->write(buf[i]);
+    }
+    return (_wire->endTransmission() == 0);
+}
+
+bool ADXL345_I2CBus::readRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    bool ok = true;
+    _wire->beginTransmission(i2cAddress);
+    ok &= (_wire->write(reg) == 1);
+    ok &= (_wire->endTransmission(false) == 0);
+    _wire->requestFrom(i2cAddress, count);
+    if (ok && _wire->available() == count) {
+        // Success
+        for(int i=0; i<count; i++){
+            buf[i] = _wire->read();
+        }
+        return true;
+    }
+    // No response, or incomplete response
+    return false;
+}
+
+/************ ADXL345_SPIBus ************/
+
+bool ADXL345_SPIBus::begin(){
+    if(mosiPin == 999){
+        _spi->begin();
+    }
+#ifdef ESP32
+    else{
+        _spi->begin(sckPin, misoPin, mosiPin, csPin);
+    }
+#endif
+#ifdef ARDUINO_ARCH_STM32
+    else {
+       _spi->setMISO(misoPin);
+       _spi->setMOSI(mosiPin);
+       _spi->setSCLK(sckPin);
+       _spi->begin();
+    }
+#endif
+    setClockSpeed(spiClock);
+    pinMode(csPin, OUTPUT);
+    digitalWrite(csPin, HIGH);
+    return true;
+}
+
+/* The FIFO needs 5 µs to pop the next entry. Up to 1.5 MHz, the address byte of the next read 
+   takes long enough, above CS has to stay high for the rest. */
+void ADXL345_SPIBus::setClockSpeed(unsigned long clock){
+    spiClock = clock;
+    mySPISettings = SPISettings(spiClock, MSBFIRST, SPI_MODE3);
+    unsigned long kHz = spiClock / 1000;
+    unsigned long addrNanos = kHz ? (8000000UL / kHz) : 5000;
+    fifoPopMicros = (addrNanos >= 5000) ? 0 : (5000 - addrNanos + 999) / 1000;
+}
+
+/* The data is sent with buffer transfers in chunks, the caller's buffer is not modified */
+bool ADXL345_SPIBus::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count){
+    uint8_t chunk[ADXL345_SPI_CHUNK_SIZE];
+    if(count > 1){
+        reg |= 0x40;
+    }
+    _spi->beginTransaction(mySPISettings);
+    select();
+    _spi->transfer(reg);
+    while(count > 0){
+        uint8_t n = (count > ADXL345_SPI_CHUNK_SIZE) ? ADXL345_SPI_CHUNK_SIZE : count;
+        memcpy(chunk, buf, n);
+        _spi->transfer(chunk, n);
+        buf += n;
+        count -= n;
+    }
+    deselect();
+    _spi->endTransaction();
+    return true; // Error checking is not possible with SPI
+}
+
+/* A read of the data registers pops the FIFO, so the next read has to wait like in 
+   readFifoEntries(), e.g. if getRawValues() is called in a loop */
+bool ADXL345_SPIBus::readRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    const bool popsFifo = (reg < ADXL345_FIFO_DATA_REG + ADXL345_FIFO_ENTRY_SIZE) 
+                          && (reg + count > ADXL345_FIFO_DATA_REG);
+    reg |= 0x80;
+    if(count > 1){
+        reg |= 0x40;
+    }
+    memset(buf, 0, count);
+    _spi->beginTransaction(mySPISettings);
+    select();
+    _spi->transfer(reg);
+    _spi->transfer(buf, count);
+    deselect();
+    if(popsFifo && fifoPopMicros){
+        delayMicroseconds(fifoPopMicros);
+    }
+    _spi->endTransaction();
+    return true; // Error checking is not possible with SPI
+}
+
+/* The bus stays reserved for the whole drain. Each entry is one buffer transfer of command + 
+   6 data bytes. Entries can't be chained within one CS frame: a multi-byte read beyond DATAZ1
+   continues with FIFO_CTL, and the FIFO only pops when CS goes high. */
+uint8_t ADXL345_SPIBus::readFifoEntries(uint8_t *buf, uint8_t entries){
+    uint8_t frame[ADXL345_FIFO_ENTRY_SIZE + 1];
+    _spi->beginTransaction(mySPISettings);
+    for(int e=0; e<entries; e++){
+        memset(frame, 0, sizeof(frame));
+        frame[0] = ADXL345_FIFO_DATA_REG | 0xC0;
+        select();
+        _spi->transfer(frame, sizeof(frame));
+        deselect();
+        memcpy(buf, frame + 1, ADXL345_FIFO_ENTRY_SIZE);
+        buf += ADXL345_FIFO_ENTRY_SIZE;
+        if(fifoPopMicros){
+            delayMicroseconds(fifoPopMicros);
+        }
+    }
+    _spi->endTransaction();
+    return entries;
+}
+
+void ADXL345_SPIBus::select(){
+    digitalWrite(csPin, LOW);
+    if(csSetupMicros){
+        delayMicroseconds(csSetupMicros);
+    }
+}
+
+void ADXL345_SPIBus::deselect(){
+    digitalWrite(csPin, HIGH);
+}
+
@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Bus transports for the ADXL345_WE / ADXL343_WE library.
+ *
+ * ADXL345_Bus is the interface the driver uses for all register accesses.
+ * ADXL345_I2CBus and ADXL345_SPIBus implement it for TwoWire and SPIClass.
+ * You can pass your own implementation (or ADXL345_SimBus, see
+ * ADXL345_SimBus.h) to the ADXL345_WE constructor.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_BUS_H_
+#define ADXL345_BUS_H_
+
+#if defined(ARDUINO) && (ARDUINO >= 100)
+ #include "Arduino.h"
+ #include <Wire.h>
+ #include <SPI.h>
+#elif defined(ARDUINO)
+ #include "WProgram.h"
+ #include <Wire.h>
+ #include <SPI.h>
+#else
+ #include "ADXL345_host.h"
+#endif
+
+class ADXL345_Bus
+{
+    public:
+        static constexpr uint8_t ADXL345_FIFO_DATA_REG   {0x32}; // DATAX0
+        static constexpr uint8_t ADXL345_FIFO_ENTRY_SIZE {6};    // bytes per x,y,z triple
+
+        virtual bool begin() { return true; }
+        virtual bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) = 0;
+        virtual bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) = 0;
+        /* Reads "entries" FIFO entries (6 bytes each) into buf. Returns the number of entries read. */
+        virtual uint8_t readFifoEntries(uint8_t *buf, uint8_t entries);
+        /* Optional non-blocking read, e.g. by DMA. Returns false if the transport cannot do it, 
+           then the caller uses readRegisters(). buf must stay valid until isTransferDone(). */
+        virtual bool startReadRegisters(uint8_t, uint8_t*, uint8_t) { return false; }
+        virtual bool isTransferDone() { return true; }
+
+    protected:
+        ~ADXL345_Bus() {}
+};
+
+class ADXL345_I2CBus : public ADXL345_Bus
+{
+    public:
+        ADXL345_I2CBus(TwoWire *w = &Wire, uint8_t addr = 0x53) : _wire{w}, i2cAddress{addr} {}
+
+        bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) override;
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+
+    protected:
+        TwoWire *_wire;
+        uint8_t i2cAddress;
+};
+
+class ADXL345_SPIBus : public ADXL345_Bus
+{
+    public:
+        static constexpr uint8_t ADXL345_SPI_CHUNK_SIZE {16}; // bytes per buffer transfer for writes
+
+        ADXL345_SPIBus(SPIClass *s = &SPI, int cs = -1, int mosi = 999, int miso = 999, int sck = 999)
+            : _spi{s}, csPin{cs}, mosiPin{mosi}, misoPin{miso}, sckPin{sck} {}
+
+        bool begin() override;
+        void setClockSpeed(unsigned long clock);
+        void setCSSetupTime(uint8_t us) { csSetupMicros = us; }
+        bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) override;
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        uint8_t readFifoEntries(uint8_t *buf, uint8_t entries) override;
+
+    protected:
+        SPIClass *_spi;
+        SPISettings mySPISettings = SPISettings();
+        unsigned long spiClock = 5000000;
+        uint8_t csSetupMicros = 0;      // datasheet minimum is 5 ns
+        uint8_t fifoPopMicros = 4;      // CS high time between FIFO reads, see setClockSpeed()
+        int csPin;
+        int mosiPin;
+        int misoPin;
+        int sckPin;
+        void select();
+        void deselect();
+};
+
+#endif
+
@@ -0,0 +1,101 @@
+/********************************************************************
+* Interrupt dispatcher for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Dispatcher.h"
+
+static const adxl345_int dispatchOrder[ADXL345_Dispatcher::ADXL345_INT_TYPES] = {
+    ADXL345_OVERRUN, ADXL345_WATERMARK, ADXL345_DATA_READY, ADXL345_FREEFALL,
+    ADXL345_SINGLE_TAP, ADXL345_DOUBLE_TAP, ADXL345_ACTIVITY, ADXL345_INACTIVITY
+};
+
+static constexpr uint8_t FIFO_INTS     {(1<<ADXL345_OVERRUN) | (1<<ADXL345_WATERMARK) | (1<<ADXL345_DATA_READY)};
+static constexpr uint8_t BURST_SIZE    {ADXL345_WE::ADXL345_INT_SOURCE - ADXL345_WE::ADXL345_ACT_TAP_STATUS + 1};
+
+void ADXL345_Dispatcher::setHandler(adxl345_int type, adxl345_intHandler handler, void *context){
+    handlers[type] = handler;
+    contexts[type] = context;
+}
+
+void ADXL345_Dispatcher::onInterrupt(){
+    if(!pending){
+        irqMicros = micros();
+        pending = true;
+    }
+}
+
+uint8_t ADXL345_Dispatcher::service(bool force){
+    bool wasPending = pending;
+    if(!wasPending && !force){
+        return 0;
+    }
+    pending = false;
+    uint32_t irq = irqMicros;
+    services++;
+
+    uint8_t status[BURST_SIZE];
+    if(!myAcc->readMultipleRegisters(ADXL345_WE::ADXL345_ACT_TAP_STATUS, BURST_SIZE, status)){
+        if(wasPending){     // INT_SOURCE is still latched, so no new edge will come: try again
+            irqMicros = irq;
+            pending = true;
+        }
+        return 0;
+    }
+    adxl345_intEvent event;
+    event.actTapStatus = status[0];
+    event.intSource = status[BURST_SIZE - 1];
+    event.fifoStatus = 0;
+    event.irqMicros = irq;
+    uint8_t fired = event.intSource & status[ADXL345_WE::ADXL345_INT_ENABLE - ADXL345_WE::ADXL345_ACT_TAP_STATUS];
+#ifdef ADXL345_ENABLE_STATS
+    if(myAcc->checkInterrupt(event.intSource, ADXL345_OVERRUN)){
+        myAcc->stats.fifoOverruns++;
+    }
+#endif
+
+    uint8_t handled = 0;
+    for(uint8_t i=0; i<ADXL345_INT_TYPES; i++){
+        if(fired & (1<<i)){
+            if(handlers[i]){
+                handled |= (1<<i);
+            }
+            else{
+                unhandled++;
+            }
+        }
+    }
+    if((handled & FIFO_INTS) && !myAcc->readRegister8(ADXL345_WE::ADXL345_FIFO_STATUS, &event.fifoStatus)){
+        event.fifoStatus = 0;
+    }
+
+    uint8_t calls = 0;
+    for(uint8_t i=0; i<ADXL345_INT_TYPES; i++){
+        adxl345_int type = dispatchOrder[i];
+        if(!(handled & (1<<type))){
+            continue;
+        }
+        if(calls == 0 && wasPending){
+            uint32_t latency = micros() - irq;
+            if(latency > maxLatency){
+                maxLatency = latency;
+            }
+        }
+        event.type = type;
+        handlers[type](contexts[type], event);
+        calls++;
+    }
+    dispatched += calls;
+    return calls;
+}
+
+void ADXL345_Dispatcher::resetCounters(){
+    services = 0;
+    dispatched = 0;
+    unhandled = 0;
+    maxLatency = 0;
+}
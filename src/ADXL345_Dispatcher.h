@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Interrupt dispatcher for the ADXL345_WE library.
+ *
+ * ADXL345_Dispatcher calls a handler function for each interrupt type you
+ * register. Call onInterrupt() from your ISR (INT1 and/or INT2) and
+ * service() from loop() or a task. service() reads the status registers
+ * with as few transactions as possible and calls the handlers of the
+ * enabled interrupts which occurred, in a fixed priority order:
+ *
+ *   overrun, watermark, data ready, free fall, single tap, double tap,
+ *   activity, inactivity
+ *
+ * Reads per service():
+ *   1. ACT_TAP_STATUS ... INT_SOURCE (0x2B - 0x30, 6 bytes) in one burst.
+ *      This includes INT_ENABLE, so that only enabled interrupts are
+ *      dispatched. Reading INT_SOURCE clears the latched events.
+ *   2. FIFO_STATUS (0x39), only if overrun, watermark or data ready
+ *      occurred and has a handler. A burst up to 0x39 is not possible:
+ *      reading DATAX0 - DATAZ1 would remove an entry from the FIFO.
+ *
+ * So the latency from the ISR to the first handler is the time until
+ * service() is called plus at most two transactions. getMaxLatency()
+ * measures it. The watermark handler has to read the FIFO below the
+ * watermark, otherwise the INT pin stays active and there is no new edge.
+ * service(true) checks the status without a pending interrupt.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_DISPATCHER_H_
+#define ADXL345_DISPATCHER_H_
+
+#include "ADXL345_WE.h"
+
+typedef struct ADXL345_INT_EVENT {
+    adxl345_int type;
+    uint8_t intSource;      // INT_SOURCE, all bits
+    uint8_t actTapStatus;   // ACT_TAP_STATUS, e.g. for the tap or activity axis
+    uint8_t fifoStatus;     // FIFO_STATUS, only read for overrun, watermark and data ready, else 0
+    uint32_t irqMicros;     // micros() in onInterrupt()
+} adxl345_intEvent;
+
+typedef void (*adxl345_intHandler)(void *context, const adxl345_intEvent &event);
+
+class ADXL345_Dispatcher
+{
+    public:
+        static constexpr uint8_t ADXL345_INT_TYPES {8};
+
+        ADXL345_Dispatcher(ADXL345_WE *acc) : myAcc{acc} {}
+
+        void setHandler(adxl345_int type, adxl345_intHandler handler, void *context = nullptr);
+        void removeHandler(adxl345_int type) { setHandler(type, nullptr); }
+        void onInterrupt();
+        /* Returns the number of handlers called */
+        uint8_t service(bool force = false);
+
+        /* Counters */
+        uint32_t getServiceCount() { return services; }
+        uint32_t getDispatched() { return dispatched; }
+        uint32_t getUnhandled() { return unhandled; }      // enabled interrupts without handler
+        uint32_t getMaxLatency() { return maxLatency; }    // µs from onInterrupt() to the first handler
+        void resetCounters();
+
+    protected:
+        ADXL345_WE *myAcc;
+        adxl345_intHandler handlers[ADXL345_INT_TYPES] = {nullptr};
+        void *contexts[ADXL345_INT_TYPES] = {nullptr};
+        volatile bool pending = false;
+        volatile uint32_t irqMicros = 0;
+        uint32_t services = 0;
+        uint32_t dispatched = 0;
+        uint32_t unhandled = 0;
+        uint32_t maxLatency = 0;
+};
+
+#endif
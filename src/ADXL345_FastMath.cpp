@@ -0,0 +1,148 @@
+/********************************************************************
+* Fast trigonometric kernels for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#if defined(ARDUINO) && (ARDUINO >= 100)
+ #include "Arduino.h"
+#elif defined(ARDUINO)
+ #include "WProgram.h"
+#else
+ #include "ADXL345_host.h"
+#endif
+
+#include "ADXL345_FastMath.h"
+
+static constexpr float HALF_PI_F  {1.5707963};
+static constexpr float PI_F       {3.1415927};
+static constexpr float DEG_PER_RAD {57.295780};
+
+/* atan(i/64) for i = 0...64 in 1/1000 degrees */
+static const uint16_t atanTable[65] PROGMEM = {
+    0, 895, 1790, 2684, 3576, 4467, 5356, 6242, 7125, 8005, 8881, 9752, 10620, 11482, 12339, 13191,
+    14036, 14876, 15709, 16535, 17354, 18166, 18970, 19767, 20556, 21337, 22109, 22874, 23629, 24376,
+    25115, 25844, 26565, 27277, 27979, 28673, 29358, 30033, 30700, 31357, 32005, 32645, 33275, 33896,
+    34509, 35112, 35707, 36293, 36870, 37439, 37999, 38550, 39094, 39629, 40156, 40675, 41186, 41689,
+    42184, 42672, 43152, 43625, 44091, 44549, 45000
+};
+
+/* Abramowitz / Stegun 4.4.45: asin(x) = pi/2 - sqrt(1 - x) * (a0 + a1*x + a2*x^2 + a3*x^3) for
+   0 <= x <= 1, max. error 5e-5 rad */
+float adxl345_fastAsinDeg(float x){
+    bool negative = x < 0;
+    if(negative){
+        x = -x;
+    }
+    if(x > 1){
+        x = 1;
+    }
+    float poly = 1.5707288 + x * (-0.2121144 + x * (0.0742610 - 0.0187293 * x));
+    float asinRad = HALF_PI_F - sqrtf(1 - x) * poly;
+    return (negative ? -asinRad : asinRad) * DEG_PER_RAD;
+}
+
+/* Abramowitz / Stegun 4.4.49 for atan(z), 0 <= z <= 1, max. error 1e-5 rad, extended to all
+   octants */
+float adxl345_fastAtan2Deg(float y, float x){
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if(ax == 0 && ay == 0){
+        return 0;
+    }
+    bool swap = ay > ax;
+    float z = swap ? (ax / ay) : (ay / ax);
+    float s = z * z;
+    float angle = z * (0.9998660 + s * (-0.3302995 + s * (0.1801410 + s * (-0.0851330 + s * 0.0208351))));
+    if(swap){
+        angle = HALF_PI_F - angle;
+    }
+    if(x < 0){
+        angle = PI_F - angle;
+    }
+    if(y < 0){
+        angle = -angle;
+    }
+    return angle * DEG_PER_RAD;
+}
+
+/* Table lookup with linear interpolation in 64 segments of the octant */
+int16_t adxl345_atan2Fixed(int32_t y, int32_t x){
+    uint32_t ax = (x < 0) ? (0UL - static_cast<uint32_t>(x)) : static_cast<uint32_t>(x);
+    uint32_t ay = (y < 0) ? (0UL - static_cast<uint32_t>(y)) : static_cast<uint32_t>(y);
+    if(ax == 0 && ay == 0){
+        return 0;
+    }
+    bool swap = ay > ax;
+    uint32_t num = swap ? ax : ay;
+    uint32_t den = swap ? ay : ax;
+    while(den > 0xFFFF){
+        num >>= 1;
+        den >>= 1;
+    }
+    uint32_t ratio = (num << 16) / den;   // 0...65536
+    uint8_t idx = ratio >> 10;
+    uint16_t frac = ratio & 0x3FF;
+    int32_t angle = pgm_read_word(&atanTable[idx]);
+    if(idx < 64){
+        int32_t next = pgm_read_word(&atanTable[idx + 1]);
+        angle += ((next - angle) * frac) >> 10;
+    }
+    if(swap){
+        angle = 90000L - angle;
+    }
+    if(x < 0){
+        angle = 180000L - angle;
+    }
+    if(y < 0){
+        angle = -angle;
+    }
+    return static_cast<int16_t>((angle + (angle >= 0 ? 5 : -5)) / 10);
+}
+
+/* asin(num/den) = atan2(num, sqrt(den^2 - num^2)). num and den are scaled to 15 bits first, so
+   that the square root has enough resolution. */
+int16_t adxl345_asinFixed(int32_t num, int32_t den){
+    if(den <= 0){
+        return 0;
+    }
+    while(den > 0x7FFF){
+        num /= 2;
+        den /= 2;
+    }
+    while(den < 0x4000){
+        num *= 2;
+        den *= 2;
+    }
+    if(num > den){
+        num = den;
+    }
+    else if(num < -den){
+        num = -den;
+    }
+    uint32_t cosVal = adxl345_isqrt(static_cast<uint32_t>(den * den) - static_cast<uint32_t>(num * num));
+    return adxl345_atan2Fixed(num, cosVal);
+}
+
+uint32_t adxl345_isqrt(uint32_t val){
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+    while(bit > val){
+        bit >>= 2;
+    }
+    while(bit != 0){
+        if(val >= res + bit){
+            val -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else{
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *
+ * Alternative trigonometric kernels for the angle, pitch and roll
+ * calculations of the ADXL345_WE library. Select them with setTrigMode():
+ *
+ *   ADXL345_TRIG_LIBM   asin() / atan2() of the math library (default)
+ *   ADXL345_TRIG_FAST   float polynomials, max. error 0.004° (asin) and
+ *                       0.001° (atan2)
+ *   ADXL345_TRIG_FIXED  integer kernels with a 65 entry table, max. error
+ *                       0.02°, no floating point operations inside
+ *
+ * The error bounds are measured against double precision with
+ * extras/benchmark/trig_benchmark.cpp. On a PC (x86 with FPU), FAST takes
+ * about 0.8x the time of LIBM for asin and 0.55x for atan2 / pitch and roll,
+ * while FIXED is slower than LIBM. FIXED is meant for controllers without
+ * FPU, such as AVR or Cortex-M0; its speed there has not been measured.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_FASTMATH_H_
+#define ADXL345_FASTMATH_H_
+
+#include <stdint.h>
+
+typedef enum ADXL345_TRIG_MODE {
+    ADXL345_TRIG_LIBM, ADXL345_TRIG_FAST, ADXL345_TRIG_FIXED,
+    ADXL343_TRIG_LIBM  = ADXL345_TRIG_LIBM,
+    ADXL343_TRIG_FAST  = ADXL345_TRIG_FAST,
+    ADXL343_TRIG_FIXED = ADXL345_TRIG_FIXED
+} adxl345_trigMode;
+
+/* Float polynomials, results in degrees */
+float adxl345_fastAsinDeg(float x);
+float adxl345_fastAtan2Deg(float y, float x);
+
+/* Integer kernels, results in 1/100 degrees */
+int16_t adxl345_atan2Fixed(int32_t y, int32_t x);
+int16_t adxl345_asinFixed(int32_t num, int32_t den);   // asin(num/den), |num| is limited to den
+uint32_t adxl345_isqrt(uint32_t val);
+
+#endif
+
@@ -0,0 +1,129 @@
+/********************************************************************
+* Digital filter stage for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include "ADXL345_Filter.h"
+
+/* Quality factors of the sections of Butterworth filters of 2nd and 4th order */
+static const float BUTTERWORTH_Q2[1] = {0.70711};
+static const float BUTTERWORTH_Q4[2] = {0.54120, 1.30656};
+
+bool ADXL345_Filter::begin(adxl345_filterType type, float cutoffHz, float sampleRateHz, uint8_t order){
+    filterType = ADXL345_FILTER_NONE;
+    sections = 0;
+    sampleRate = sampleRateHz;
+    reset();
+    if(type == ADXL345_FILTER_NONE){
+        return true;
+    }
+    if(cutoffHz <= 0.0 || cutoffHz >= sampleRateHz / 2 || (order != 2 && order != 4)){
+        return false;
+    }
+    const float *q = (order == 4) ? BUTTERWORTH_Q4 : BUTTERWORTH_Q2;
+    const double scale = 1L << ADXL345_FILTER_COEF_BITS;
+    double w0 = 2.0 * M_PI * cutoffHz / sampleRateHz;
+    double cosW0 = cos(w0);
+    for(uint8_t s=0; s<order/2; s++){
+        /* Audio EQ cookbook (R. Bristow-Johnson) */
+        double alpha = sin(w0) / (2.0 * q[s]);
+        double a0 = 1.0 + alpha;
+        double b1 = (type == ADXL345_LOW_PASS) ? 1.0 - cosW0 : -(1.0 + cosW0);
+        double b0 = fabs(b1) / 2.0;
+        sect[s].b0 = lround(b0 / a0 * scale);
+        sect[s].b1 = lround(b1 / a0 * scale);
+        sect[s].b2 = sect[s].b0;
+        sect[s].a1 = lround(-2.0 * cosW0 / a0 * scale);
+        sect[s].a2 = lround((1.0 - alpha) / a0 * scale);
+    }
+    sections = order / 2;
+    filterType = type;
+    return true;
+}
+
+void ADXL345_Filter::setDecimation(uint8_t factor){
+    decimation = (factor == 0) ? 1 : factor;
+    phase = 0;
+}
+
+void ADXL345_Filter::reset(){
+    primed = false;
+    phase = 0;
+}
+
+uint16_t ADXL345_Filter::process(const xyzInt16 *in, xyzInt16 *out, uint16_t n){
+    if(n == 0){
+        return 0;
+    }
+    if(!primed){
+        prime(in[0]);
+        primed = true;
+    }
+    uint16_t count = 0;
+    for(uint16_t i=0; i<n; i++){
+        xyzInt16 val = in[i];   // out[count] may be in[i]
+        if(sections){
+            val.x = filter(0, val.x);
+            val.y = filter(1, val.y);
+            val.z = filter(2, val.z);
+        }
+        if(++phase >= decimation){
+            phase = 0;
+            out[count++] = val;
+        }
+    }
+    return count;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+/* A low pass passes a constant value, a high pass outputs 0 */
+void ADXL345_Filter::prime(const xyzInt16 &val){
+    const int16_t v[3] = {val.x, val.y, val.z};
+    for(uint8_t axis=0; axis<3; axis++){
+        int32_t x = static_cast<int32_t>(v[axis]) * (1L << ADXL345_FILTER_STATE_BITS);
+        for(uint8_t s=0; s<sections; s++){
+            int32_t y = (filterType == ADXL345_LOW_PASS) ? x : 0;
+            x1[s][axis] = x;
+            x2[s][axis] = x;
+            y1[s][axis] = y;
+            y2[s][axis] = y;
+            rem[s][axis] = 0;
+            x = y;
+        }
+    }
+}
+
+int16_t ADXL345_Filter::filter(uint8_t axis, int16_t val){
+    int32_t x = static_cast<int32_t>(val) * (1L << ADXL345_FILTER_STATE_BITS);
+    for(uint8_t s=0; s<sections; s++){
+        const Section &c = sect[s];
+        int64_t acc = static_cast<int64_t>(c.b0) * x + static_cast<int64_t>(c.b1) * x1[s][axis]
+                    + static_cast<int64_t>(c.b2) * x2[s][axis] - static_cast<int64_t>(c.a1) * y1[s][axis]
+                    - static_cast<int64_t>(c.a2) * y2[s][axis] + rem[s][axis];
+        int32_t y = static_cast<int32_t>(acc >> ADXL345_FILTER_COEF_BITS);
+        /* Error feedback: the truncated bits go into the next value. Otherwise the rounding errors 
+           are amplified by the filter gain near the poles, which is large for low cutoffs. */
+        rem[s][axis] = static_cast<int32_t>(acc - static_cast<int64_t>(y) * (1LL << ADXL345_FILTER_COEF_BITS));
+        x2[s][axis] = x1[s][axis];
+        x1[s][axis] = x;
+        y2[s][axis] = y1[s][axis];
+        y1[s][axis] = y;
+        x = y;
+    }
+    int32_t out = (x + (1L << (ADXL345_FILTER_STATE_BITS - 1))) >> ADXL345_FILTER_STATE_BITS;
+    if(out > INT16_MAX){
+        out = INT16_MAX;
+    }
+    else if(out < INT16_MIN){
+        out = INT16_MIN;
+    }
+    return static_cast<int16_t>(out);
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ *
+ * Digital filter stage for the ADXL345_WE library.
+ *
+ * ADXL345_Filter filters blocks of raw values, e.g. from readFifo(), with a
+ * Butterworth low pass or high pass of 2nd or 4th order and optionally keeps
+ * only every n-th value (decimation). The high pass removes gravity and slow
+ * tilts, e.g. for vibration measurements. Input and output are raw values,
+ * so the results can be converted with rawToGValues() (low pass) or by
+ * multiplying with the LSB value (high pass, there is no offset anymore).
+ *
+ * The filters are biquad sections in direct form I with fixed point
+ * coefficients (ADXL345_FILTER_COEF_BITS fractional bits), a 64 bit
+ * accumulator and error feedback, so that also cutoffs far below the sample
+ * rate work. All state is part of the object, nothing is allocated.
+ * Filter stages can be chained: e.g. a 4th order low pass at 3200 Hz with
+ * decimation 32 followed by a high pass at 100 Hz. Each stage can work in
+ * place (in == out).
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_FILTER_H_
+#define ADXL345_FILTER_H_
+
+#include <stdint.h>
+#include "xyzInt16.h"
+
+typedef enum ADXL345_FILTER_TYPE {
+    ADXL345_FILTER_NONE, ADXL345_LOW_PASS, ADXL345_HIGH_PASS,
+    ADXL343_FILTER_NONE = ADXL345_FILTER_NONE,
+    ADXL343_LOW_PASS    = ADXL345_LOW_PASS,
+    ADXL343_HIGH_PASS   = ADXL345_HIGH_PASS
+} adxl345_filterType;
+
+class ADXL345_Filter
+{
+    public:
+        static constexpr uint8_t ADXL345_FILTER_MAX_SECTIONS {2};    // 4th order
+        static constexpr uint8_t ADXL345_FILTER_COEF_BITS    {28};
+        static constexpr uint8_t ADXL345_FILTER_STATE_BITS   {12};    // fractional bits of the history
+
+        /* order: 2 or 4. Returns false for invalid parameters, then the filter passes the values. */
+        bool begin(adxl345_filterType type, float cutoffHz, float sampleRateHz, uint8_t order = 2);
+        /* Keep only every factor-th value (1 = all) */
+        void setDecimation(uint8_t factor);
+        float getOutputRate() { return sampleRate / decimation; }
+        /* Clears the history. The next value initializes it as if it had been constant before. */
+        void reset();
+        /* Filters n values, in and out may be the same buffer. Returns the number of values in out. */
+        uint16_t process(const xyzInt16 *in, xyzInt16 *out, uint16_t n);
+
+    protected:
+        struct Section
+        {
+            int32_t b0, b1, b2, a1, a2;   // a0 = 1
+        };
+        adxl345_filterType filterType = ADXL345_FILTER_NONE;
+        float sampleRate = 0.0;
+        uint8_t sections = 0;
+        Section sect[ADXL345_FILTER_MAX_SECTIONS];
+        int32_t x1[ADXL345_FILTER_MAX_SECTIONS][3];     // inputs and outputs of the sections,
+        int32_t x2[ADXL345_FILTER_MAX_SECTIONS][3];     // with ADXL345_FILTER_STATE_BITS
+        int32_t y1[ADXL345_FILTER_MAX_SECTIONS][3];
+        int32_t y2[ADXL345_FILTER_MAX_SECTIONS][3];
+        int32_t rem[ADXL345_FILTER_MAX_SECTIONS][3];    // truncated bits of the last output
+        uint8_t decimation = 1;
+        uint8_t phase = 0;
+        bool primed = false;
+        void prime(const xyzInt16 &val);
+        int16_t filter(uint8_t axis, int16_t val);
+};
+
+#endif
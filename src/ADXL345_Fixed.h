@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * Compile-time configured variant of the ADXL345_WE driver.
+ *
+ * ADXL345_Fixed<Bus, RANGE, FULL_RES> is for applications in which bus,
+ * range and resolution never change. The bus type is a template parameter,
+ * so register accesses are direct calls without the runtime SPI / I2C
+ * decision and without virtual dispatch. The data format and the scale 
+ * factors are constexpr, so conversions are a multiplication with a 
+ * constant. It offers the data path (raw values, g, milli-g, FIFO) and 
+ * plain register access. For everything else use ADXL345_WE.
+ *
+ * Example:
+ *   ADXL345_SPIBus spiBus(&SPI, CS_PIN);
+ *   ADXL345_Fixed<ADXL345_SPIBus, ADXL345_RANGE_16G, true> myAcc(spiBus);
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_FIXED_H_
+#define ADXL345_FIXED_H_
+
+#include "ADXL345_WE.h"
+
+template <class Bus, adxl345_range RANGE, bool FULL_RES = true>
+class ADXL345_Fixed
+{
+    static_assert(RANGE != ADXL345_RANGE_ERROR, "ADXL345_Fixed needs a valid range");
+
+    public:
+        static constexpr uint8_t DATA_FORMAT_VAL = static_cast<uint8_t>(RANGE) 
+                                                 | (FULL_RES ? (1 << ADXL345_WE::ADXL345_FULL_RES) : 0);
+        /* Full resolution: 3.9 mg/LSB in all ranges, 10 bit: the LSB doubles with each range */
+        static constexpr float MILLI_G_PER_LSB = ADXL345_WE::MILLI_G_PER_LSB 
+                                               * (FULL_RES ? 1 : (1 << static_cast<uint8_t>(RANGE)));
+        static constexpr float G_PER_LSB = MILLI_G_PER_LSB / 1000.0f;
+        static constexpr int32_t MG_GAIN_Q = static_cast<int32_t>(MILLI_G_PER_LSB 
+                                                                  * (1L << ADXL345_WE::MG_Q_BITS) + 0.5f);
+
+        ADXL345_Fixed(Bus &b) : bus(b) {}
+
+        /* Sets data format and default data rate and starts measuring */
+        bool init(adxl345_dataRate rate = ADXL345_DATA_RATE_100){
+            if(!bus.Bus::begin()){
+                return false;
+            }
+            writeRegister(ADXL345_WE::ADXL345_POWER_CTL, 0);
+            writeRegister(ADXL345_WE::ADXL345_DATA_FORMAT, DATA_FORMAT_VAL);
+            writeRegister(ADXL345_WE::ADXL345_BW_RATE, static_cast<uint8_t>(rate));
+            writeRegister(ADXL345_WE::ADXL345_POWER_CTL, 1 << ADXL345_MEASURE);
+            uint8_t format = 0;
+            return readRegister(ADXL345_WE::ADXL345_DATA_FORMAT, &format) && format == DATA_FORMAT_VAL;
+        }
+
+        bool setDataRate(adxl345_dataRate rate){
+            if(rate == ADXL345_DATA_RATE_ERROR){
+                return false;
+            }
+            return writeRegister(ADXL345_WE::ADXL345_BW_RATE, static_cast<uint8_t>(rate));
+        }
+
+        /* FIFO_CTL is written as a whole: mode, trigger pin and number of samples */
+        bool setFifo(adxl345_fifoMode mode, adxl345_triggerInt intNumber = ADXL345_TRIGGER_INT_1, 
+                     uint8_t samples = 32){
+            uint8_t val = (static_cast<uint8_t>(mode) << 6) | ((samples - 1) & 0x1F);
+            if(intNumber == ADXL345_TRIGGER_INT_2){
+                val |= 0x20;
+            }
+            return writeRegister(ADXL345_WE::ADXL345_FIFO_CTL, val);
+        }
+
+        bool getRawValues(xyzInt16 *rawVal){
+            uint8_t rawData[6];
+            if(!bus.Bus::readRegisters(ADXL345_WE::ADXL345_DATAX0, rawData, 6)){
+                return false;
+            }
+            toXyz(rawData, rawVal);
+            return true;
+        }
+
+        bool getGValues(xyzFloat *gVal){
+            xyzInt16 rawVal;
+            if(!getRawValues(&rawVal)){
+                return false;
+            }
+            *gVal = rawToG(rawVal);
+            return true;
+        }
+
+        bool getMilliGValues(xyzInt16 *mgVal){
+            if(!getRawValues(mgVal)){
+                return false;
+            }
+            *mgVal = rawToMilliG(*mgVal);
+            return true;
+        }
+
+        static xyzFloat rawToG(const xyzInt16 &rawVal){
+            return xyzFloat(rawVal.x * G_PER_LSB, rawVal.y * G_PER_LSB, rawVal.z * G_PER_LSB);
+        }
+
+        static xyzInt16 rawToMilliG(const xyzInt16 &rawVal){
+            return xyzInt16(toMilliG(rawVal.x), toMilliG(rawVal.y), toMilliG(rawVal.z));
+        }
+
+        /* Like ADXL345_WE::readFifo() */
+        uint8_t readFifo(xyzInt16 *rawBuf, uint8_t maxSamples){
+            uint8_t status = 0;
+            if(!readRegister(ADXL345_WE::ADXL345_FIFO_STATUS, &status)){
+                return 0;
+            }
+            uint8_t entries = status & ADXL345_WE::ADXL345_FIFO_ENTRIES;
+            if(entries > maxSamples){
+                entries = maxSamples;
+            }
+            uint8_t *rawData = reinterpret_cast<uint8_t*>(rawBuf);
+            uint8_t delivered = bus.Bus::readFifoEntries(rawData, entries);
+            for(int i=0; i<delivered; i++){
+                toXyz(rawData + 6*i, &rawBuf[i]);
+            }
+            return delivered;
+        }
+
+        bool writeRegister(uint8_t reg, uint8_t val){
+            return bus.Bus::writeRegisters(reg, &val, 1);
+        }
+
+        bool readRegister(uint8_t reg, uint8_t *val){
+            return bus.Bus::readRegisters(reg, val, 1);
+        }
+
+    protected:
+        Bus &bus;
+
+        static void toXyz(const uint8_t *rawData, xyzInt16 *rawVal){
+            int16_t x = static_cast<int16_t>((rawData[1] << 8) | rawData[0]);
+            int16_t y = static_cast<int16_t>((rawData[3] << 8) | rawData[2]);
+            int16_t z = static_cast<int16_t>((rawData[5] << 8) | rawData[4]);
+            rawVal->x = x;
+            rawVal->y = y;
+            rawVal->z = z;
+        }
+
+        static int16_t toMilliG(int16_t raw){
+            return static_cast<int16_t>((raw * MG_GAIN_Q + (1L << (ADXL345_WE::MG_Q_BITS - 1))) 
+                                        >> ADXL345_WE::MG_Q_BITS);
+        }
+};
+
+template <class Bus, adxl345_range RANGE, bool FULL_RES>
+constexpr uint8_t ADXL345_Fixed<Bus, RANGE, FULL_RES>::DATA_FORMAT_VAL;
+template <class Bus, adxl345_range RANGE, bool FULL_RES>
+constexpr float ADXL345_Fixed<Bus, RANGE, FULL_RES>::MILLI_G_PER_LSB;
+template <class Bus, adxl345_range RANGE, bool FULL_RES>
+constexpr float ADXL345_Fixed<Bus, RANGE, FULL_RES>::G_PER_LSB;
+template <class Bus, adxl345_range RANGE, bool FULL_RES>
+constexpr int32_t ADXL345_Fixed<Bus, RANGE, FULL_RES>::MG_GAIN_Q;
+
+#endif
@@ -0,0 +1,385 @@
+/********************************************************************
+* Multi-sensor reader for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include "ADXL345_Group.h"
+
+static constexpr uint8_t FIFO_FULL   {32};
+static constexpr float SKEW_GAIN     {0.0625};  // share of the deviation per service() applied to skew
+static constexpr float SKEW_LIMIT    {0.75};    // periods, correct the index of a sensor beyond this
+static constexpr uint8_t SETTLE_POLLS {8};      // service() calls to check the index after a full FIFO
+static constexpr float RATE_WINDOW   {256.0};   // periods over which the drift is measured
+
+ADXL345_Group::ADXL345_Group(ADXL345_WE **sensors, uint8_t count, xyzInt16 *queueBuf, uint8_t depth, 
+                             const uint8_t *busIds)
+    : acc{sensors}, count{count}, queue{queueBuf}, depth{depth}
+{
+    if(this->count > ADXL345_GROUP_MAX_SENSORS){
+        this->count = ADXL345_GROUP_MAX_SENSORS;
+    }
+    // Stable insertion sort by bus, so that sensors on one bus are visited consecutively
+    for(int i=0; i<this->count; i++){
+        uint8_t j = i;
+        while(busIds && j > 0 && busIds[order[j-1]] > busIds[i]){
+            order[j] = order[j-1];
+            j--;
+        }
+        order[j] = i;
+    }
+    clearQueues();
+}
+
+/* All sensors get the same data rate. The FIFOs are cleared first and then started in a
+   second loop, so that they start as close together as possible. The remaining difference
+   of the start times sets the first index of each sensor. */
+bool ADXL345_Group::begin(adxl345_dataRate rate){
+    if(count == 0 || depth == 0){
+        return false;
+    }
+    dataRate = rate;
+    bool ok = true;
+    for(int i=0; i<count; i++){
+        ok &= acc[i]->setDataRate(rate);
+        ok &= acc[i]->setFifoMode(ADXL345_BYPASS);
+    }
+    clearQueues();
+    const float perMicro = ADXL345_WE::dataRateToHz(rate) / 1000000.0;
+    unsigned long firstStart = 0;
+    for(int i=0; i<count; i++){
+        unsigned long t = micros();
+        ok &= acc[i]->setFifoMode(ADXL345_STREAM);
+        t += (micros() - t) / 2;
+        if(i == 0){
+            firstStart = t;
+        }
+        nextIndex[i] = lround((t - firstStart) * perMicro);
+        headIndex[i] = nextIndex[i];
+    }
+    resetCounters();
+    return ok;
+}
+
+/* Polls the FIFO levels of all sensors (one byte each), then drains them in the order of the
+   schedule. A sensor is only drained as far as its queue has space, the rest stays in its
+   FIFO. Returns the number of samples drained. */
+uint16_t ADXL345_Group::service(){
+    unsigned long start = micros();
+    uint8_t level[ADXL345_GROUP_MAX_SENSORS];
+    uint8_t seq[ADXL345_GROUP_MAX_SENSORS];
+    unsigned long pollMicros[ADXL345_GROUP_MAX_SENSORS];
+    for(int i=0; i<count; i++){
+        uint8_t idx = order[(rrStart + i) % count];
+        unsigned long t = micros();
+        level[idx] = acc[idx]->getFifoStatus() & ADXL345_WE::ADXL345_FIFO_ENTRIES;
+        pollMicros[idx] = t + (micros() - t) / 2;
+        if(level[idx] >= FIFO_FULL){
+            fullFifos++;
+        }
+        seq[i] = idx;
+    }
+
+    updateIndices(level, pollMicros);
+    if(schedule == ADXL345_FULLEST_FIRST){
+        for(int i=1; i<count; i++){
+            uint8_t idx = seq[i];
+            uint8_t j = i;
+            while(j > 0 && level[seq[j-1]] < level[idx]){
+                seq[j] = seq[j-1];
+                j--;
+            }
+            seq[j] = idx;
+        }
+    }
+    rrStart = (rrStart + 1) % count;
+
+    uint16_t drained = 0;
+    for(int i=0; i<count; i++){
+        uint8_t idx = seq[i];
+        uint8_t remaining = level[idx];
+        while(remaining > 0 && qCount[idx] < depth){
+            uint8_t tail = (qHead[idx] + qCount[idx]) % depth;
+            uint8_t n = depth - tail;   // contiguous space
+            if(n > depth - qCount[idx]){
+                n = depth - qCount[idx];
+            }
+            if(n > remaining){
+                n = remaining;
+            }
+            uint8_t got = acc[idx]->drainFifo(&queue[idx * depth + tail], n);
+            qCount[idx] += got;
+            nextIndex[idx] += got;
+            remaining -= got;
+            drained += got;
+            if(got < n){
+                break;
+            }
+        }
+    }
+    samplesDrained += drained;
+    busyMicros += micros() - start;
+    return drained;
+}
+
+/* Restarts all FIFOs and clears the queues, e.g. after data of one sensor was lost */
+bool ADXL345_Group::resync(){
+    return begin(dataRate);
+}
+
+uint8_t ADXL345_Group::framesAvailable(){
+    if(count == 0 || !align()){
+        return 0;
+    }
+    uint8_t frames = depth;
+    for(int i=0; i<count; i++){
+        if(usable(i) < frames){
+            frames = usable(i);
+        }
+    }
+    return frames;
+}
+
+bool ADXL345_Group::readFrame(xyzInt16 *frame){
+    if(framesAvailable() == 0){
+        return false;
+    }
+    for(int i=0; i<count; i++){
+        frame[i] = queue[i * depth + qHead[i]];
+        pop(i, 1);
+    }
+    return true;
+}
+
+float ADXL345_Group::getConfiguredRate(){
+    return count * ADXL345_WE::dataRateToHz(dataRate);
+}
+
+/* Samples per second the group could drain if the CPU did nothing else, measured over all
+   service() calls since begin() or resetCounters(). Returns 0 before the first drain. */
+float ADXL345_Group::getAchievableRate(){
+    if(busyMicros == 0){
+        return 0.0;
+    }
+    return samplesDrained * 1000000.0 / busyMicros;
+}
+
+uint32_t ADXL345_Group::getLostSamples(uint8_t sensor){
+    return (sensor < count) ? lost[sensor] : 0;
+}
+
+void ADXL345_Group::resetCounters(){
+    samplesDrained = 0;
+    fullFifos = 0;
+    droppedSamples = 0;
+    busyMicros = 0;
+    for(int i=0; i<count; i++){
+        lost[i] = 0;
+    }
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+void ADXL345_Group::clearQueues(){
+    for(int i=0; i<count; i++){
+        qHead[i] = 0;
+        qCount[i] = 0;
+        headIndex[i] = 0;
+        nextIndex[i] = 0;
+        gapLeft[i] = 0;
+        skew[i] = 0.0;
+        skewRate[i] = 0.0;
+        rateSkew[i] = 0.0;
+        rateMicros[i] = micros();   // in case the drift measurement never passes the start
+        settle[i] = 0;
+    }
+    polls = 0;
+    rrStart = 0;
+}
+
+/* The index after the newest sample of a sensor is nextIndex + level. Corrected by the poll
+   times, its deviation from sensor 0 is the skew (in periods) plus noise of up to one period,
+   minus the samples lost in a full FIFO. The skew is averaged and predicted with its rate of
+   change, i.e. the drift, which is measured over RATE_WINDOW periods.
+   The time line is taken from the first sensor with a settled index and without a full FIFO.
+   If all FIFOs are full, it is predicted from the last poll, but not behind the sensor which
+   lost the fewest samples. A single poll only estimates the lost samples to +/-1, so the
+   index is checked with the average of the next SETTLE_POLLS polls. Until then, the samples
+   after the gap are not used for frames. */
+void ADXL345_Group::updateIndices(const uint8_t *level, const unsigned long *pollMicros){
+    const float perMicro = ADXL345_WE::dataRateToHz(dataRate) / 1000000.0;
+    const uint32_t base = nextIndex[0] + level[0];
+    const float since = polls ? static_cast<long>(pollMicros[0] - lineMicros) : 0.0;
+    float dev[ADXL345_GROUP_MAX_SENSORS];
+    int8_t ref = -1;
+    float line = -1.0e9;
+    for(int i=0; i<count; i++){
+        skew[i] += skewRate[i] * since;
+        dev[i] = static_cast<int32_t>(nextIndex[i] + level[i] - base)
+                 - static_cast<long>(pollMicros[i] - pollMicros[0]) * perMicro - skew[i];
+        if(level[i] >= FIFO_FULL){
+            line = (dev[i] > line) ? dev[i] : line;
+        }
+        else if(ref < 0 && settle[i] == 0){
+            ref = i;
+        }
+    }
+    for(int i=0; ref < 0 && i<count; i++){
+        if(level[i] < FIFO_FULL){
+            ref = i;        // all indices are being checked, this one defines the time line
+            settle[i] = 0;
+        }
+    }
+    if(ref >= 0){
+        line = dev[ref];
+    }
+    else if(polls > 0){
+        float predicted = static_cast<int32_t>(lineIndex - base) + since * perMicro;
+        line = (predicted > line) ? predicted : line;
+    }
+    lineIndex = base + lround(line);
+    lineMicros = pollMicros[0];
+    const float gain = (polls < 1.0 / SKEW_GAIN) ? 1.0 / (polls + 1) : SKEW_GAIN;  // average at the start
+    polls++;
+
+    for(int i=0; i<count; i++){
+        float err = dev[i] - line;
+        if(level[i] >= FIFO_FULL){
+            int32_t missing = lround(-err);
+            if(missing < 0){
+                missing = 0;
+            }
+            lost[i] += missing;
+            setGap(i, nextIndex[i] + missing);
+            settle[i] = SETTLE_POLLS;
+            settleSum[i] = 0.0;
+        }
+        else if(i == ref){
+            continue;
+        }
+        else if(settle[i]){
+            settleSum[i] += err;
+            if(--settle[i] > 0){
+                continue;
+            }
+            float avg = settleSum[i] / SETTLE_POLLS;
+            int32_t wrong = lround(avg);
+            if(gapLeft[i] == 0){
+                headIndex[i] -= wrong;
+            }
+            gapIndex[i] -= wrong;
+            nextIndex[i] -= wrong;
+            skew[i] += avg - wrong;
+        }
+        else{
+            skew[i] += gain * err;
+            float window = static_cast<long>(pollMicros[0] - rateMicros[i]);
+            if(gain > SKEW_GAIN){       // the drift is measured after the start
+                rateSkew[i] = skew[i];
+                rateMicros[i] = pollMicros[0];
+            }
+            else if(window * perMicro >= RATE_WINDOW){
+                skewRate[i] += 0.5 * ((skew[i] - rateSkew[i]) / window - skewRate[i]);
+                rateSkew[i] = skew[i];
+                rateMicros[i] = pollMicros[0];
+            }
+        }
+        if(skew[i] > SKEW_LIMIT || skew[i] < -SKEW_LIMIT){
+            shiftIndex(i, -lround(skew[i]));
+        }
+    }
+}
+
+/* The next sample drained from the FIFO of sensor idx gets the index. The queue keeps the
+   samples before the gap. Only one gap per queue is tracked: if there is one already, the
+   samples before it are given up, or, if the index after it was not checked yet, the
+   samples after it. */
+void ADXL345_Group::setGap(uint8_t idx, uint32_t index){
+    if(settle[idx]){
+        droppedSamples += qCount[idx] - gapLeft[idx];
+        qCount[idx] = gapLeft[idx];
+    }
+    else if(gapLeft[idx]){
+        droppedSamples += gapLeft[idx];
+        pop(idx, gapLeft[idx]);
+    }
+    gapLeft[idx] = 0;
+    if(qCount[idx] == 0){
+        headIndex[idx] = index;
+    }
+    else{
+        gapLeft[idx] = qCount[idx];
+        gapIndex[idx] = index;
+    }
+    nextIndex[idx] = index;
+}
+
+/* Moves sensor idx by delta periods on the time line. The samples in the queue were taken
+   before and keep their index, unless they follow a gap or are still being checked. */
+void ADXL345_Group::shiftIndex(uint8_t idx, int32_t delta){
+    if(qCount[idx] == 0 || (settle[idx] && gapLeft[idx] == 0)){
+        headIndex[idx] += delta;
+    }
+    else if(gapLeft[idx] == 0){
+        gapLeft[idx] = qCount[idx];
+        gapIndex[idx] = nextIndex[idx];
+    }
+    gapIndex[idx] += delta;
+    nextIndex[idx] += delta;
+    skew[idx] += delta;
+    rateSkew[idx] += delta;
+}
+
+/* Removes n samples (at most segment(idx)) from the head of the queue */
+void ADXL345_Group::pop(uint8_t idx, uint8_t n){
+    qHead[idx] = (qHead[idx] + n) % depth;
+    qCount[idx] -= n;
+    headIndex[idx] += n;
+    if(gapLeft[idx]){
+        gapLeft[idx] -= n;
+        if(gapLeft[idx] == 0){
+            headIndex[idx] = gapIndex[idx];
+        }
+    }
+}
+
+/* Drops the samples which are older than the newest queue head, since they have no partner
+   in the other queues. Returns true if all queue heads have the same index. */
+bool ADXL345_Group::align(){
+    uint32_t target;
+    bool moved;
+    do{
+        moved = false;
+        target = headIndex[0];
+        for(int i=1; i<count; i++){
+            if(static_cast<int32_t>(headIndex[i] - target) > 0){
+                target = headIndex[i];
+            }
+        }
+        for(int i=0; i<count; i++){
+            uint32_t behind = target - headIndex[i];
+            uint8_t n = usable(i);
+            if(behind == 0 || n == 0){
+                continue;
+            }
+            if(behind < n){
+                n = behind;
+            }
+            pop(i, n);
+            droppedSamples += n;
+            moved = true;   // after a gap the head may be ahead of target
+        }
+    } while(moved);
+    for(int i=0; i<count; i++){
+        if(headIndex[i] != target || qCount[i] == 0){
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+ *
+ * Multi-sensor reader for the ADXL345_WE library.
+ *
+ * ADXL345_Group runs up to 8 ADXL345 with the same data rate, each with its
+ * FIFO in stream mode. service() polls the FIFO levels of all sensors and
+ * drains them into one queue per sensor, either round robin or the fullest
+ * FIFO first. Sensors with the same busId are drained back to back.
+ *
+ * readFrame() delivers one sample per sensor. The sensors are not
+ * synchronized: the FIFOs start one after another, the oscillators differ
+ * by up to a few percent, and samples are lost if a FIFO is full (because
+ * service() came too late or a queue was full). Therefore each sample gets
+ * an index on a common time line: from the start times of the FIFOs, and
+ * from the FIFO levels and poll times in service(), which show the drift
+ * of each sensor against the others. If the drift exceeds 3/4 of a sample
+ * period, the index of the following samples is corrected. After a full
+ * FIFO the number of lost samples is estimated from the time line; the
+ * following samples are held back until some more polls have confirmed
+ * their index. A frame only combines samples with the same index, samples
+ * without a partner are dropped (getDroppedSamples()).
+ *
+ * So the samples of a frame were taken less than one sample period apart,
+ * provided that service() is called before the FIFOs are full most of the
+ * time. If the FIFOs overflow at nearly every call, the indices cannot be
+ * checked any more and frames may be off by a few periods; use resync().
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_GROUP_H_
+#define ADXL345_GROUP_H_
+
+#include "ADXL345_WE.h"
+
+typedef enum ADXL345_GROUP_SCHEDULE {
+    ADXL345_ROUND_ROBIN, ADXL345_FULLEST_FIRST,
+    ADXL343_ROUND_ROBIN   = ADXL345_ROUND_ROBIN,
+    ADXL343_FULLEST_FIRST = ADXL345_FULLEST_FIRST
+} adxl345_groupSchedule;
+
+class ADXL345_Group
+{
+    public:
+        static constexpr uint8_t ADXL345_GROUP_MAX_SENSORS {8};
+
+        /* queueBuf holds count * depth samples. busIds (optional) tells which sensors share a bus. */
+        ADXL345_Group(ADXL345_WE **sensors, uint8_t count, xyzInt16 *queueBuf, uint8_t depth, 
+                      const uint8_t *busIds = nullptr);
+
+        bool begin(adxl345_dataRate rate);
+        void setSchedule(adxl345_groupSchedule sched) { schedule = sched; }
+        uint16_t service();
+        bool resync();
+
+        /* Frames, i.e. one sample per sensor */
+        uint8_t framesAvailable();
+        bool readFrame(xyzInt16 *frame);
+
+        /* Rates in samples per second, summed up over all sensors */
+        float getConfiguredRate();
+        float getAchievableRate();
+
+        /* Counters */
+        uint32_t getSamplesDrained() { return samplesDrained; }
+        uint32_t getFullFifos() { return fullFifos; }   // FIFO was full when polled, data may be lost
+        uint32_t getLostSamples(uint8_t sensor);         // estimated from the FIFO levels and poll times
+        uint32_t getDroppedSamples() { return droppedSamples; }   // no partner for a frame
+        uint32_t getBusyMicros() { return busyMicros; }
+        void resetCounters();
+
+    protected:
+        ADXL345_WE **acc;
+        uint8_t count;
+        xyzInt16 *queue;
+        uint8_t depth;
+        adxl345_groupSchedule schedule = ADXL345_ROUND_ROBIN;
+        adxl345_dataRate dataRate = ADXL345_DATA_RATE_100;
+        uint8_t order[ADXL345_GROUP_MAX_SENSORS];   // sensor indices sorted by bus
+        uint8_t qHead[ADXL345_GROUP_MAX_SENSORS];
+        uint8_t qCount[ADXL345_GROUP_MAX_SENSORS];
+        /* Sample indices on the common time line */
+        uint32_t headIndex[ADXL345_GROUP_MAX_SENSORS];  // oldest sample in the queue
+        uint32_t nextIndex[ADXL345_GROUP_MAX_SENSORS];  // next sample drained from the FIFO
+        uint8_t gapLeft[ADXL345_GROUP_MAX_SENSORS];     // queued samples before a gap, 0 = no gap
+        uint32_t gapIndex[ADXL345_GROUP_MAX_SENSORS];   // index of the first sample after the gap
+        float skew[ADXL345_GROUP_MAX_SENSORS];          // filtered index deviation from sensor 0
+        float skewRate[ADXL345_GROUP_MAX_SENSORS];      // drift against sensor 0, periods per µs
+        float rateSkew[ADXL345_GROUP_MAX_SENSORS];      // skew at the start of the drift measurement
+        unsigned long rateMicros[ADXL345_GROUP_MAX_SENSORS];
+        uint8_t settle[ADXL345_GROUP_MAX_SENSORS];      // polls left to check the index after a full FIFO
+        float settleSum[ADXL345_GROUP_MAX_SENSORS];
+        uint32_t lost[ADXL345_GROUP_MAX_SENSORS] = {0};
+        uint32_t lineIndex = 0;     // time line at the last service()
+        unsigned long lineMicros = 0;
+        uint16_t polls = 0;
+        uint8_t rrStart = 0;
+        uint32_t samplesDrained = 0;
+        uint32_t fullFifos = 0;
+        uint32_t droppedSamples = 0;
+        uint32_t busyMicros = 0;
+        void clearQueues();
+        void updateIndices(const uint8_t *level, const unsigned long *pollMicros);
+        void setGap(uint8_t idx, uint32_t index);
+        void shiftIndex(uint8_t idx, int32_t delta);
+        void pop(uint8_t idx, uint8_t n);
+        /* Samples at the head of the queue without a gap, and of them the ones usable for frames */
+        uint8_t segment(uint8_t idx) { return gapLeft[idx] ? gapLeft[idx] : qCount[idx]; }
+        uint8_t usable(uint8_t idx) { return settle[idx] ? gapLeft[idx] : segment(idx); }
+        bool align();
+};
+
+#endif
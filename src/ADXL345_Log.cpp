@@ -0,0 +1,354 @@
+/********************************************************************
+* Compact binary log format for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <string.h>
+#include "ADXL345_Log.h"
+
+static constexpr uint8_t MARKER_1          {0xFF};
+static constexpr uint8_t MARKER_2          {0x00};
+static constexpr uint8_t FRAME_HEADER      {'H'};
+static constexpr uint8_t FRAME_SYNC        {'S'};
+static constexpr uint8_t HEADER_PAYLOAD    {37};
+static constexpr uint8_t MAX_VALUE_BYTES   {3};     // zigzag of a 17 bit difference
+static constexpr uint8_t MAX_INDEX_BYTES   {5};
+
+enum {PARSE_CORRUPT = -1, PARSE_INCOMPLETE = 0, PARSE_HEADER = 1, PARSE_SYNC = 2};
+
+static uint8_t crc8(const uint8_t *data, size_t len){
+    uint8_t crc = 0;
+    for(size_t i=0; i<len; i++){
+        crc ^= data[i];
+        for(int bit=0; bit<8; bit++){
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t putVarint(uint32_t val, uint8_t *out){
+    uint8_t n = 0;
+    while(val > 0x7F){
+        out[n++] = (val & 0x7F) | 0x80;
+        val >>= 7;
+    }
+    out[n++] = val;
+    return n;
+}
+
+static uint32_t zigzag(int32_t val){
+    return (val < 0) ? (static_cast<uint32_t>(-val) << 1) - 1 : static_cast<uint32_t>(val) << 1;
+}
+
+static int32_t unzigzag(uint32_t val){
+    return (val & 1) ? -static_cast<int32_t>(val >> 1) - 1 : static_cast<int32_t>(val >> 1);
+}
+
+/* Returns the number of bytes, 0 if incomplete, -1 if the varint is not one an encoder writes */
+static int8_t getVarint(const uint8_t *data, size_t len, uint8_t maxBytes, uint32_t *val){
+    *val = 0;
+    for(uint8_t i=0; i<maxBytes; i++){
+        if(i == len){
+            return 0;
+        }
+        *val |= static_cast<uint32_t>(data[i] & 0x7F) << (7 * i);
+        if(!(data[i] & 0x80)){
+            return (i > 0 && data[i] == 0) ? -1 : i + 1;
+        }
+    }
+    return -1;
+}
+
+static void putFloat(float val, uint8_t *out){
+    uint32_t bits;
+    memcpy(&bits, &val, 4);
+    for(int i=0; i<4; i++){
+        out[i] = bits >> (8 * i);
+    }
+}
+
+static float getFloat(const uint8_t *data){
+    uint32_t bits = 0;
+    for(int i=0; i<4; i++){
+        bits |= static_cast<uint32_t>(data[i]) << (8 * i);
+    }
+    float val;
+    memcpy(&val, &bits, 4);
+    return val;
+}
+
+/************************************************
+    ADXL345_LogEncoder
+*************************************************/
+
+void ADXL345_LogEncoder::begin(uint16_t syncInterval){
+    interval = (syncInterval > 0) ? syncInterval : 1;
+    index = 0;
+    sinceSync = 0;
+    syncPending = true;
+}
+
+size_t ADXL345_LogEncoder::writeHeader(ADXL345_WE *acc, uint8_t *out){
+    adxl345_logHeader header;
+    header.dataRate = acc->getDataRate();
+    header.range = acc->getRange();
+    header.rateHz = ADXL345_WE::dataRateToHz(header.dataRate);
+    header.rangeFactor = acc->getRangeFactor();
+    acc->getScaling(&header.offset, &header.factor);
+    header.syncInterval = interval;
+    return writeHeader(header, out);
+}
+
+size_t ADXL345_LogEncoder::writeHeader(const adxl345_logHeader &header, uint8_t *out){
+    out[0] = MARKER_1;
+    out[1] = MARKER_2;
+    out[2] = FRAME_HEADER;
+    out[3] = HEADER_PAYLOAD;
+    uint8_t *p = out + 4;
+    p[0] = ADXL345_LOG_VERSION;
+    p[1] = header.dataRate;
+    p[2] = header.range;
+    const float vals[8] = {header.rateHz, header.rangeFactor, header.offset.x, header.offset.y, header.offset.z,
+                           header.factor.x, header.factor.y, header.factor.z};
+    for(int i=0; i<8; i++){
+        putFloat(vals[i], p + 3 + 4 * i);
+    }
+    p[35] = header.syncInterval & 0xFF;
+    p[36] = header.syncInterval >> 8;
+    out[4 + HEADER_PAYLOAD] = crc8(out + 2, 2 + HEADER_PAYLOAD);
+    syncPending = true;    // the decoder may start reading here
+    return ADXL345_LOG_HEADER_BYTES;
+}
+
+size_t ADXL345_LogEncoder::encode(const xyzInt16 *rawVal, uint16_t n, uint8_t *out){
+    uint8_t *p = out;
+    for(uint16_t i=0; i<n; i++){
+        const int16_t v[3] = {rawVal[i].x, rawVal[i].y, rawVal[i].z};
+        if(syncPending || sinceSync >= interval){
+            uint8_t *frame = p;
+            *p++ = MARKER_1;
+            *p++ = MARKER_2;
+            *p++ = FRAME_SYNC;
+            p += putVarint(index, p);
+            for(int axis=0; axis<3; axis++){
+                p += putVarint(zigzag(v[axis]), p);
+            }
+            *p = crc8(frame + 2, p - frame - 2);
+            p++;
+            sinceSync = 0;
+            syncPending = false;
+        }
+        else{
+            for(int axis=0; axis<3; axis++){
+                p += putVarint(zigzag(static_cast<int32_t>(v[axis]) - prev[axis]), p);
+            }
+        }
+        for(int axis=0; axis<3; axis++){
+            prev[axis] = v[axis];
+        }
+        sinceSync++;
+        index++;
+    }
+    return p - out;
+}
+
+size_t ADXL345_LogEncoder::getMaxBytes(uint16_t n){
+    size_t syncs = n / interval + 1;
+    return static_cast<size_t>(n) * ADXL345_LOG_SAMPLE_BYTES
+         + syncs * (ADXL345_LOG_SYNC_BYTES - ADXL345_LOG_SAMPLE_BYTES);
+}
+
+void ADXL345_LogEncoder::markGap(uint32_t lostSamples){
+    index += lostSamples;
+    syncPending = true;
+}
+
+/************************************************
+    ADXL345_LogDecoder
+*************************************************/
+
+void ADXL345_LogDecoder::reset(){
+    headerValid = false;
+    synced = false;
+    nextIndex = 0;
+    headerCount = 0;
+    syncCount = 0;
+    errors = 0;
+}
+
+uint16_t ADXL345_LogDecoder::decode(const uint8_t *data, size_t len, size_t *used, xyzInt16 *out, uint32_t *index,
+                                    uint16_t maxOut){
+    size_t pos = 0;
+    uint16_t count = 0;
+    while(count < maxOut && pos < len){
+        const uint8_t *p = data + pos;
+        size_t rest = len - pos;
+        if(p[0] == MARKER_1 && (rest < 2 || p[1] == MARKER_2)){
+            if(rest < 2){
+                break;
+            }
+            size_t frameLen;
+            xyzInt16 val;
+            uint32_t idx;
+            int8_t res = parseFrame(p, rest, &frameLen, &val, &idx);
+            if(res == PARSE_INCOMPLETE){
+                break;
+            }
+            if(res == PARSE_CORRUPT){
+                errors++;
+                synced = false;
+                pos += 2;
+                lose(data, len, &pos);
+                continue;
+            }
+            pos += frameLen;
+            if(res == PARSE_SYNC){
+                out[count] = val;
+                if(index){
+                    index[count] = idx;
+                }
+                count++;
+            }
+            continue;
+        }
+        if(!synced){
+            lose(data, len, &pos);
+            continue;
+        }
+
+        int16_t v[3];
+        size_t n = 0;
+        int8_t res = 1;
+        for(int axis=0; axis<3 && res > 0; axis++){
+            uint32_t zz;
+            res = getVarint(p + n, rest - n, MAX_VALUE_BYTES, &zz);
+            int32_t val = prev[axis] + unzigzag(zz);
+            if(res > 0 && (val < INT16_MIN || val > INT16_MAX)){
+                res = -1;
+            }
+            v[axis] = val;
+            n += (res > 0) ? res : 0;
+        }
+        if(res == 0){
+            break;
+        }
+        if(res < 0){
+            errors++;
+            synced = false;
+            pos++;
+            lose(data, len, &pos);
+            continue;
+        }
+        pos += n;
+        out[count] = xyzInt16(v[0], v[1], v[2]);
+        if(index){
+            index[count] = nextIndex;
+        }
+        count++;
+        nextIndex++;
+        for(int axis=0; axis<3; axis++){
+            prev[axis] = v[axis];
+        }
+    }
+    *used = pos;
+    return count;
+}
+
+bool ADXL345_LogDecoder::getHeader(adxl345_logHeader *header){
+    if(!headerValid){
+        return false;
+    }
+    *header = hdr;
+    return true;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+/* data starts with the marker. Returns PARSE_HEADER or PARSE_SYNC and the length of the frame,
+   PARSE_INCOMPLETE or PARSE_CORRUPT. */
+int8_t ADXL345_LogDecoder::parseFrame(const uint8_t *data, size_t len, size_t *frameLen, xyzInt16 *val,
+                                      uint32_t *idx){
+    if(len < 3){
+        return PARSE_INCOMPLETE;
+    }
+    if(data[2] == FRAME_HEADER){
+        if(len < 4){
+            return PARSE_INCOMPLETE;
+        }
+        size_t total = 5 + data[3];
+        if(len < total){
+            return PARSE_INCOMPLETE;
+        }
+        const uint8_t *p = data + 4;
+        if(data[3] < HEADER_PAYLOAD || p[0] != ADXL345_LOG_VERSION || crc8(data + 2, total - 3) != data[total - 1]){
+            return PARSE_CORRUPT;
+        }
+        hdr.dataRate = static_cast<adxl345_dataRate>(p[1]);
+        hdr.range = static_cast<adxl345_range>(p[2]);
+        hdr.rateHz = getFloat(p + 3);
+        hdr.rangeFactor = getFloat(p + 7);
+        hdr.offset = xyzFloat(getFloat(p + 11), getFloat(p + 15), getFloat(p + 19));
+        hdr.factor = xyzFloat(getFloat(p + 23), getFloat(p + 27), getFloat(p + 31));
+        hdr.syncInterval = p[35] | (p[36] << 8);
+        headerValid = true;
+        headerCount++;
+        *frameLen = total;
+        return PARSE_HEADER;
+    }
+    if(data[2] != FRAME_SYNC){
+        return PARSE_CORRUPT;
+    }
+    size_t n = 3;
+    uint32_t raw[4];
+    for(int i=0; i<4; i++){
+        int8_t res = getVarint(data + n, len - n, (i == 0) ? MAX_INDEX_BYTES : MAX_VALUE_BYTES, &raw[i]);
+        if(res <= 0){
+            return res;
+        }
+        n += res;
+    }
+    if(n == len){
+        return PARSE_INCOMPLETE;
+    }
+    int32_t v[3];
+    for(int axis=0; axis<3; axis++){
+        v[axis] = unzigzag(raw[axis + 1]);
+        if(v[axis] < INT16_MIN || v[axis] > INT16_MAX){
+            return PARSE_CORRUPT;
+        }
+    }
+    if(crc8(data + 2, n - 2) != data[n]){
+        return PARSE_CORRUPT;
+    }
+    for(int axis=0; axis<3; axis++){
+        prev[axis] = v[axis];
+    }
+    *val = xyzInt16(v[0], v[1], v[2]);
+    *idx = raw[0];
+    nextIndex = raw[0] + 1;
+    synced = true;
+    syncCount++;
+    *frameLen = n + 1;
+    return PARSE_SYNC;
+}
+
+/* Skips to the next marker. A single 0xFF at the end is kept, it may be the start of one. */
+void ADXL345_LogDecoder::lose(const uint8_t *data, size_t len, size_t *pos){
+    size_t i = *pos;
+    for(; i + 1 < len; i++){
+        if(data[i] == MARKER_1 && data[i+1] == MARKER_2){
+            break;
+        }
+    }
+    if(i + 1 == len && data[i] != MARKER_1){
+        i = len;
+    }
+    *pos = i;
+}
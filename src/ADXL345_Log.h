@@ -0,0 +1,112 @@
+/******************************************************************************
+ *
+ * Compact binary log format for the ADXL345_WE library.
+ *
+ * ADXL345_LogEncoder turns blocks of raw values, e.g. directly the buffer
+ * of readFifo(), into a byte stream for flash or radio, ADXL345_LogDecoder
+ * turns it back into raw values. Typically a sample needs 3 to 5 bytes
+ * instead of 12 (xyzFloat) or 20+ (text).
+ *
+ * Stream layout:
+ *
+ *   header frame  FF 00 'H' len payload crc
+ *                 payload: version, data rate, range (codes as in
+ *                 ADXL345_WE.h), floats (little endian IEEE 754): rate in
+ *                 Hz, range factor, offset x/y/z, factor x/y/z, then the sync
+ *                 interval (uint16_t). g = (raw - offset) * factor, i.e. the
+ *                 scaling including the calibration at the time of the header.
+ *   sync frame    FF 00 'S' index x y z crc
+ *                 index: number of the sample (varint), x, y, z: absolute
+ *                 raw values (zigzag varints). Written before the first
+ *                 sample, every syncInterval samples and after a gap.
+ *   sample        dx dy dz: differences to the previous sample as zigzag
+ *                 varints (7 bits per byte, bit 7 = more bytes follow)
+ *
+ * crc: CRC-8 (polynomial 0x07) over the frame from the type byte on. A
+ * varint never contains FF 00 (an encoder does not write a last byte of
+ * zero), so a decoder finds the next frame after corrupted or lost bytes.
+ * Damaged differences can not always be detected, they affect the samples
+ * up to the next sync frame. If that matters, use a transport with its own
+ * CRC (radio, file system).
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_LOG_H_
+#define ADXL345_LOG_H_
+
+#include "ADXL345_WE.h"
+
+static constexpr uint8_t ADXL345_LOG_VERSION {1};
+
+typedef struct ADXL345_LOG_HEADER {
+    adxl345_dataRate dataRate;
+    adxl345_range range;
+    float rateHz;
+    float rangeFactor;
+    xyzFloat offset;
+    xyzFloat factor;
+    uint16_t syncInterval;
+} adxl345_logHeader;
+
+class ADXL345_LogEncoder
+{
+    public:
+        static constexpr uint8_t ADXL345_LOG_HEADER_BYTES  {42};
+        static constexpr uint8_t ADXL345_LOG_SAMPLE_BYTES  {9};     // max.
+        static constexpr uint8_t ADXL345_LOG_SYNC_BYTES    {18};    // max.
+
+        /* syncInterval: samples from one sync frame to the next (1 ... 65535) */
+        void begin(uint16_t syncInterval = 256);
+        /* Writes a header with the current settings and scaling of acc, at most
+           ADXL345_LOG_HEADER_BYTES. Write a new one after changing range or calibration. */
+        size_t writeHeader(ADXL345_WE *acc, uint8_t *out);
+        size_t writeHeader(const adxl345_logHeader &header, uint8_t *out);
+        /* Encodes n raw values into out, which needs getMaxBytes(n) bytes. Returns the bytes written. */
+        size_t encode(const xyzInt16 *rawVal, uint16_t n, uint8_t *out);
+        size_t getMaxBytes(uint16_t n);
+        /* Samples were lost, e.g. after a FIFO overrun: the next sample gets a sync frame */
+        void markGap(uint32_t lostSamples);
+        uint32_t getSampleIndex() { return index; }
+
+    protected:
+        uint16_t interval = 256;
+        uint16_t sinceSync = 0;
+        uint32_t index = 0;
+        int16_t prev[3] = {0, 0, 0};
+        bool syncPending = true;
+};
+
+class ADXL345_LogDecoder
+{
+    public:
+        void reset();
+        /* Decodes the complete frames and samples of len bytes, at most maxOut samples. *used
+           returns the bytes processed, pass the rest again together with the next bytes.
+           index (optional, may be nullptr) receives the sample numbers. Returns the number of
+           samples in out. */
+        uint16_t decode(const uint8_t *data, size_t len, size_t *used, xyzInt16 *out, uint32_t *index,
+                        uint16_t maxOut);
+        bool getHeader(adxl345_logHeader *header);
+        uint32_t getHeaderCount() { return headerCount; }
+        uint32_t getSyncCount() { return syncCount; }
+        /* Number of corrupted frames or samples, each one means data up to the next frame is lost */
+        uint32_t getErrors() { return errors; }
+
+    protected:
+        adxl345_logHeader hdr;
+        bool headerValid = false;
+        bool synced = false;
+        int16_t prev[3] = {0, 0, 0};
+        uint32_t nextIndex = 0;
+        uint32_t headerCount = 0;
+        uint32_t syncCount = 0;
+        uint32_t errors = 0;
+        int8_t parseFrame(const uint8_t *data, size_t len, size_t *frameLen, xyzInt16 *val, uint32_t *idx);
+        void lose(const uint8_t *data, size_t len, size_t *pos);
+};
+
+#endif
@@ -0,0 +1,24 @@
+/******************************************************************************
+ *
+ * Compile time options for the ADXL345_WE / ADXL343_WE library.
+ *
+ * Uncomment a line to enable the option, or pass it to the compiler 
+ * (e.g. -DADXL345_ENABLE_STATS) for host builds.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_OPTIONS_H_
+#define ADXL345_OPTIONS_H_
+
+/* Counters and histograms per ADXL345_WE object, see ADXL345_Stats.h. Costs about 120 bytes 
+   of RAM per object and a micros() call per bus access. */
+// #define ADXL345_ENABLE_STATS
+
+/* Use the scalar code in ADXL345_Block.cpp even if the compiler targets SSE2, AVX2 or NEON */
+// #define ADXL345_NO_SIMD
+
+#endif
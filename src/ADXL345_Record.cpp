@@ -0,0 +1,284 @@
+/********************************************************************
+* Record and replay of the bus traffic for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Record.h"
+
+static constexpr uint8_t RECORD_WRITE        {'W'};
+static constexpr uint8_t RECORD_READ         {'R'};
+static constexpr uint8_t RECORD_FIFO         {'F'};
+static constexpr uint8_t FILE_HEADER_BYTES   {6};
+static constexpr uint8_t ACT_TAP_STATUS_REG  {0x2B};
+static constexpr uint8_t INT_SOURCE_REG      {0x30};
+static constexpr uint8_t FIFO_STATUS_REG     {0x39};
+
+/* Accesses recorded in ADXL345_RECORD_DATA mode */
+static bool isDataAccess(uint8_t reg, uint8_t count){
+    uint16_t last = reg + count - 1;
+    return (reg <= ACT_TAP_STATUS_REG && last >= ACT_TAP_STATUS_REG)
+        || (reg <= FIFO_STATUS_REG && last >= INT_SOURCE_REG);
+}
+
+/************************************************
+    ADXL345_RecordBus
+*************************************************/
+
+bool ADXL345_RecordBus::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count){
+    bool ok = bus->writeRegisters(reg, buf, count);
+    if(mode == ADXL345_RECORD_ALL){
+        record(RECORD_WRITE, reg, count, ok, buf, count);
+    }
+    return ok;
+}
+
+bool ADXL345_RecordBus::readRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    bool ok = bus->readRegisters(reg, buf, count);
+    if(mode == ADXL345_RECORD_ALL || isDataAccess(reg, count)){
+        record(RECORD_READ, reg, count, ok, buf, ok ? count : 0);
+    }
+    return ok;
+}
+
+uint8_t ADXL345_RecordBus::readFifoEntries(uint8_t *buf, uint8_t entries){
+    uint8_t delivered = bus->readFifoEntries(buf, entries);
+    record(RECORD_FIFO, ADXL345_FIFO_DATA_REG, entries, delivered, buf,
+           static_cast<size_t>(delivered) * ADXL345_FIFO_ENTRY_SIZE);
+    return delivered;
+}
+
+bool ADXL345_RecordBus::startReadRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    if(!bus->startReadRegisters(reg, buf, count)){
+        return false;
+    }
+    pendingBuf = buf;
+    pendingReg = reg;
+    pendingCount = count;
+    return true;
+}
+
+bool ADXL345_RecordBus::isTransferDone(){
+    if(!bus->isTransferDone()){
+        return false;
+    }
+    if(pendingBuf){
+        if(mode == ADXL345_RECORD_ALL || isDataAccess(pendingReg, pendingCount)){
+            record(RECORD_READ, pendingReg, pendingCount, true, pendingBuf, pendingCount);
+        }
+        pendingBuf = nullptr;
+    }
+    return true;
+}
+
+/************************************************
+    ADXL345_ReplayBus
+*************************************************/
+
+void ADXL345_ReplayBus::rewind(){
+    valid = len >= FILE_HEADER_BYTES && data[0] == 'A' && data[1] == 'X' && data[2] == 'R' && data[3] == 'B'
+         && data[4] == ADXL345_RECORD_VERSION && data[5] <= ADXL345_RECORD_DATA;
+    mode = valid ? static_cast<adxl345_recordMode>(data[5]) : ADXL345_RECORD_ALL;
+    pos = valid ? FILE_HEADER_BYTES : len;
+    for(uint8_t i=0; i<ADXL345_REPLAY_REG_COUNT; i++){
+        regs[i] = 0;
+    }
+    posMicros = 0;
+    recordMicros = 0;
+    mismatches = 0;
+    skipped = 0;
+    fifoRest = nullptr;
+    fifoRestEntries = 0;
+    paceStart = micros();
+}
+
+bool ADXL345_ReplayBus::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count){
+    Record rec;
+    bool found = (mode == ADXL345_RECORD_ALL) && seek(RECORD_WRITE, reg, count, buf, &rec);
+    setImage(reg, buf, count);
+    return found ? rec.status : true;
+}
+
+bool ADXL345_ReplayBus::readRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    Record rec;
+    bool recorded = (mode == ADXL345_RECORD_ALL) || isDataAccess(reg, count);
+    if(recorded && seek(RECORD_READ, reg, count, nullptr, &rec)){
+        for(uint8_t i=0; i<rec.payloadLen; i++){
+            buf[i] = rec.payload[i];
+        }
+        return rec.status;
+    }
+    for(uint8_t i=0; i<count; i++){
+        uint16_t r = reg + i;
+        buf[i] = (r < ADXL345_REPLAY_REG_COUNT) ? regs[r] : 0;
+    }
+    return true;
+}
+
+/* A FIFO record is used up even if the driver reads fewer entries than recorded: the rest is
+   delivered by the next calls. */
+uint8_t ADXL345_ReplayBus::readFifoEntries(uint8_t *buf, uint8_t entries){
+    if(fifoRestEntries == 0){
+        Record rec;
+        if(!seek(RECORD_FIFO, ADXL345_FIFO_DATA_REG, 0, nullptr, &rec)){
+            return 0;
+        }
+        fifoRest = rec.payload;
+        fifoRestEntries = rec.status;
+    }
+    uint8_t n = (entries < fifoRestEntries) ? entries : fifoRestEntries;
+    if(n < fifoRestEntries){
+        mismatches++;
+    }
+    size_t bytes = static_cast<size_t>(n) * ADXL345_FIFO_ENTRY_SIZE;
+    for(size_t i=0; i<bytes; i++){
+        buf[i] = fifoRest[i];
+    }
+    fifoRest += bytes;
+    fifoRestEntries -= n;
+    return n;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+void ADXL345_RecordBus::record(uint8_t type, uint8_t reg, uint8_t count, uint8_t status, const uint8_t *data,
+                               size_t len){
+    uint32_t now = micros();
+    if(!started){
+        const uint8_t header[FILE_HEADER_BYTES] = {'A', 'X', 'R', 'B', ADXL345_RECORD_VERSION, mode};
+        sink(sinkContext, header, FILE_HEADER_BYTES);
+        bytes += FILE_HEADER_BYTES;
+        lastMicros = now;
+        started = true;
+    }
+    uint8_t head[9];
+    uint8_t n = 0;
+    head[n++] = type;
+    uint32_t dt = now - lastMicros;
+    while(dt > 0x7F){
+        head[n++] = (dt & 0x7F) | 0x80;
+        dt >>= 7;
+    }
+    head[n++] = dt;
+    head[n++] = reg;
+    head[n++] = count;
+    head[n++] = status;
+    sink(sinkContext, head, n);
+    if(len){
+        sink(sinkContext, data, len);
+    }
+    lastMicros = now;
+    records++;
+    bytes += n + len;
+}
+
+bool ADXL345_ReplayBus::parse(size_t at, uint32_t baseMicros, Record *rec, size_t *next){
+    size_t p = at;
+    if(p >= len){
+        return false;
+    }
+    rec->type = data[p++];
+    uint32_t dt = 0;
+    for(uint8_t shift=0; ; shift+=7){
+        if(p >= len || shift > 28){
+            return false;
+        }
+        dt |= static_cast<uint32_t>(data[p] & 0x7F) << shift;
+        if(!(data[p++] & 0x80)){
+            break;
+        }
+    }
+    if(p + 3 > len){
+        return false;
+    }
+    rec->timeMicros = baseMicros + dt;
+    rec->reg = data[p++];
+    rec->count = data[p++];
+    rec->status = data[p++];
+    switch(rec->type){
+        case RECORD_WRITE: rec->payloadLen = rec->count; break;
+        case RECORD_READ:  rec->payloadLen = rec->status ? rec->count : 0; break;
+        case RECORD_FIFO:  rec->payloadLen = static_cast<size_t>(rec->status) * ADXL345_FIFO_ENTRY_SIZE; break;
+        default: return false;
+    }
+    if(p + rec->payloadLen > len){
+        return false;
+    }
+    rec->payload = data + p;
+    *next = p + rec->payloadLen;
+    return true;
+}
+
+/* Looks for the next record of this access. If found, the records before it are skipped and
+   applied to the register image, and the record becomes the current position. */
+bool ADXL345_ReplayBus::seek(uint8_t type, uint8_t reg, uint8_t count, const uint8_t *writeData, Record *rec){
+    if(isAtEnd()){
+        return false;
+    }
+    size_t at = pos;
+    uint32_t atMicros = posMicros;
+    for(uint8_t i=0; i<ADXL345_REPLAY_LOOKAHEAD; i++){
+        size_t next;
+        if(!parse(at, atMicros, rec, &next)){
+            if(i == 0){
+                pos = len;      // damaged or truncated, end the replay
+            }
+            break;
+        }
+        bool match = rec->type == type && (type == RECORD_FIFO || (rec->reg == reg && rec->count == count));
+        for(uint8_t j=0; match && writeData && j<count; j++){
+            match = rec->payload[j] == writeData[j];
+        }
+        if(!match && rec->type == RECORD_FIFO){
+            break;      // samples are never skipped
+        }
+        if(match){
+            size_t p = pos;
+            uint32_t pMicros = posMicros;
+            Record skip;
+            while(p != at){     // apply the skipped records
+                parse(p, pMicros, &skip, &p);
+                pMicros = skip.timeMicros;
+                apply(skip);
+                skipped++;
+            }
+            apply(*rec);
+            pos = next;
+            posMicros = rec->timeMicros;
+            recordMicros = rec->timeMicros;
+            if(pacing){
+                while(micros() - paceStart < recordMicros){}
+            }
+            return true;
+        }
+        at = next;
+        atMicros = rec->timeMicros;
+    }
+    mismatches++;
+    return false;
+}
+
+void ADXL345_ReplayBus::apply(const Record &rec){
+    if(rec.type == RECORD_FIFO){
+        if(rec.payloadLen){
+            setImage(rec.reg, rec.payload + rec.payloadLen - ADXL345_FIFO_ENTRY_SIZE, ADXL345_FIFO_ENTRY_SIZE);
+        }
+    }
+    else if(rec.payloadLen){
+        setImage(rec.reg, rec.payload, rec.payloadLen);
+    }
+}
+
+void ADXL345_ReplayBus::setImage(uint8_t reg, const uint8_t *buf, uint8_t count){
+    for(uint8_t i=0; i<count; i++){
+        uint16_t r = reg + i;
+        if(r < ADXL345_REPLAY_REG_COUNT){
+            regs[r] = buf[i];
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/******************************************************************************
+ *
+ * Record and replay of the bus traffic for the ADXL345_WE library.
+ *
+ * ADXL345_RecordBus sits between the driver and the real transport and
+ * passes every access on. In addition it writes each transfer with a time
+ * stamp to a sink function, e.g. to a file on an SD card or to Serial:
+ *
+ *   ADXL345_I2CBus i2c(&Wire, 0x53);
+ *   ADXL345_RecordBus recorder(&i2c, writeToFile, &file);
+ *   ADXL345_WE myAcc(&recorder);
+ *
+ * ADXL345_RECORD_ALL records all register reads and writes (writeRegister(),
+ * readRegister8(), readMultipleRegisters(), FIFO reads). ADXL345_RECORD_DATA
+ * only records the reads of the data and status registers (ACT_TAP_STATUS,
+ * INT_SOURCE ... FIFO_STATUS), i.e. the samples and events, which needs
+ * less space.
+ *
+ * ADXL345_ReplayBus plays a recording back to the driver, e.g. on a Linux
+ * host, so that changes can be tested and benchmarked with identical real
+ * world data, without the sensor and without reproducing the motion. Each
+ * access is answered by the next matching record (same kind, register and
+ * length, FIFO reads may differ in length). Records the driver does not ask
+ * for (within ADXL345_REPLAY_LOOKAHEAD records) are skipped, but never a
+ * FIFO read, so no samples are lost. Accesses without a record are answered
+ * from an image of the registers. Both are counted, so a replay with the
+ * same code and settings shows 0 mismatches.
+ *
+ * File format: "AXRB", version, mode, then records:
+ *   type ('W' write, 'R' read, 'F' FIFO read), time since the previous
+ *   record in µs (varint, 7 bits per byte), register, count, status, data.
+ *   status: 1/0 for success (W, R) or the number of FIFO entries read (F).
+ *   data: count bytes for W, count bytes for R if successful, status * 6
+ *   bytes for F.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_RECORD_H_
+#define ADXL345_RECORD_H_
+
+#include "ADXL345_Bus.h"
+
+typedef enum ADXL345_RECORD_MODE {
+    ADXL345_RECORD_ALL, ADXL345_RECORD_DATA,
+    ADXL343_RECORD_ALL  = ADXL345_RECORD_ALL,
+    ADXL343_RECORD_DATA = ADXL345_RECORD_DATA
+} adxl345_recordMode;
+
+static constexpr uint8_t ADXL345_RECORD_VERSION {1};
+
+/* Receives the recording, the bytes of a record can come in several calls */
+typedef void (*adxl345_recordWrite)(void *context, const uint8_t *data, size_t len);
+
+class ADXL345_RecordBus : public ADXL345_Bus
+{
+    public:
+        ADXL345_RecordBus(ADXL345_Bus *b, adxl345_recordWrite w, void *context = nullptr,
+                          adxl345_recordMode m = ADXL345_RECORD_ALL)
+            : bus{b}, sink{w}, sinkContext{context}, mode{m} {}
+
+        bool begin() override { return bus->begin(); }
+        bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) override;
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        uint8_t readFifoEntries(uint8_t *buf, uint8_t entries) override;
+        bool startReadRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        bool isTransferDone() override;
+
+        uint32_t getRecords() { return records; }
+        uint32_t getBytes() { return bytes; }
+
+    protected:
+        ADXL345_Bus *bus;
+        adxl345_recordWrite sink;
+        void *sinkContext;
+        adxl345_recordMode mode;
+        bool started = false;
+        uint32_t lastMicros = 0;
+        uint32_t records = 0;
+        uint32_t bytes = 0;
+        uint8_t *pendingBuf = nullptr;      // non-blocking read, recorded when it is done
+        uint8_t pendingReg = 0;
+        uint8_t pendingCount = 0;
+        void record(uint8_t type, uint8_t reg, uint8_t count, uint8_t status, const uint8_t *data, size_t len);
+};
+
+class ADXL345_ReplayBus : public ADXL345_Bus
+{
+    public:
+        static constexpr uint8_t ADXL345_REPLAY_LOOKAHEAD  {16};
+        static constexpr uint8_t ADXL345_REPLAY_REG_COUNT  {0x3A};
+
+        /* The recording has to stay valid while the object is used */
+        ADXL345_ReplayBus(const uint8_t *recording, size_t length) : data{recording}, len{length} { rewind(); }
+
+        bool begin() override { return valid; }     // false if the recording has no valid header
+        bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) override;
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        uint8_t readFifoEntries(uint8_t *buf, uint8_t entries) override;
+
+        void rewind();
+        bool isAtEnd() { return pos >= len; }
+        adxl345_recordMode getMode() { return mode; }
+        /* Wait until the recorded time of a record has passed, i.e. replay in real time */
+        void setPacing(bool realTime) { pacing = realTime; paceStart = micros(); }
+        /* Time stamp of the last record used, µs from the first record */
+        uint32_t getRecordMicros() { return recordMicros; }
+        uint32_t getMismatches() { return mismatches; }
+        uint32_t getSkipped() { return skipped; }
+
+    protected:
+        struct Record
+        {
+            uint8_t type;
+            uint8_t reg;
+            uint8_t count;
+            uint8_t status;
+            uint32_t timeMicros;
+            const uint8_t *payload;
+            size_t payloadLen;
+        };
+        const uint8_t *data;
+        size_t len;
+        size_t pos = 0;
+        bool valid = false;
+        adxl345_recordMode mode = ADXL345_RECORD_ALL;
+        uint8_t regs[ADXL345_REPLAY_REG_COUNT];
+        uint32_t posMicros = 0;     // time stamp of the record before pos
+        uint32_t recordMicros = 0;
+        uint32_t mismatches = 0;
+        uint32_t skipped = 0;
+        const uint8_t *fifoRest = nullptr;  // FIFO entries of a record not yet delivered
+        uint8_t fifoRestEntries = 0;
+        bool pacing = false;
+        uint32_t paceStart = 0;
+        bool parse(size_t at, uint32_t baseMicros, Record *rec, size_t *next);
+        bool seek(uint8_t type, uint8_t reg, uint8_t count, const uint8_t *writeData, Record *rec);
+        void apply(const Record &rec);
+        void setImage(uint8_t reg, const uint8_t *buf, uint8_t count);
+};
+
+#endif
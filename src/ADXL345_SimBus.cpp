@@ -0,0 +1,303 @@
+/********************************************************************
+* Software model of the ADXL345 / ADXL343 for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_SimBus.h"
+
+void ADXL345_SimBus::reset(){
+    for(int i=0; i<ADXL345_SIM_REG_COUNT; i++){
+        regs[i] = 0;
+    }
+    regs[ADXL345_WE::ADXL345_DEVID] = ADXL345_WE::ADXL345_DEVICE_ID_VAL;
+    regs[ADXL345_WE::ADXL345_BW_RATE] = ADXL345_DATA_RATE_100;
+    for(int i=0; i<3; i++){
+        lastOut[i] = 0;
+    }
+    fifoHead = 0;
+    fifoCount = 0;
+    latchedInt = 0;
+    overrun = false;
+    triggered = false;
+    accel = xyzFloat(0.0, 0.0, 1.0);
+    source = nullptr;
+    sourceContext = nullptr;
+    usAccu = 0.0;
+    rateErrorPpm = 0.0;
+    errOffset = xyzFloat(0.0, 0.0, 0.0);
+    errGain = xyzFloat(1.0, 1.0, 1.0);
+    transferUsPerByte = 0.0;
+    transferUsLeft = 0.0;
+    pendingBuf = nullptr;
+    resetCounters();
+}
+
+bool ADXL345_SimBus::writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count){
+    transactions++;
+    bytes += count + 1;
+    for(int i=0; i<count; i++, reg++){
+        if(!isWritable(reg)){
+            continue;
+        }
+        if(reg == ADXL345_WE::ADXL345_FIFO_CTL){
+            uint8_t newMode = buf[i] >> 6;
+            if(newMode != fifoMode() && newMode == ADXL345_BYPASS){
+                // switching to bypass mode clears the FIFO and the trigger
+                fifoCount = 0;
+                triggered = false;
+            }
+        }
+        regs[reg] = buf[i];
+    }
+    return true;
+}
+
+/* A read that touches the data registers pops one FIFO entry at the end of the transaction */
+bool ADXL345_SimBus::readRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    transactions++;
+    bytes += count + 1;
+    bool dataRead = false;
+    for(int i=0; i<count; i++, reg++){
+        buf[i] = readRegister(reg);
+        if(reg >= ADXL345_WE::ADXL345_DATAX0 && reg <= ADXL345_WE::ADXL345_DATAZ1){
+            dataRead = true;
+        }
+    }
+    if(dataRead){
+        popSample();
+    }
+    return true;
+}
+
+/* The data is taken when the transfer completes in advanceMicros(), like with DMA */
+bool ADXL345_SimBus::startReadRegisters(uint8_t reg, uint8_t *buf, uint8_t count){
+    if(transferUsPerByte <= 0.0 || pendingBuf){
+        return false;
+    }
+    pendingReg = reg;
+    pendingBuf = buf;
+    pendingCount = count;
+    transferUsLeft = transferUsPerByte * (count + 1);
+    return true;
+}
+
+void ADXL345_SimBus::setAcceleration(const xyzFloat &g){
+    accel = g;
+    source = nullptr;
+}
+
+void ADXL345_SimBus::setSampleSource(adxl345_simSource src, void *context){
+    source = src;
+    sourceContext = context;
+}
+
+void ADXL345_SimBus::generateSamples(uint16_t n){
+    if(!(regs[ADXL345_WE::ADXL345_POWER_CTL] & (1<<ADXL345_MEASURE))){
+        return;
+    }
+    for(int i=0; i<n; i++){
+        if(source){
+            xyzFloat g;
+            if(source(sourceContext, &g)){
+                accel = g;
+            }
+        }
+        addSample(accel);
+    }
+}
+
+void ADXL345_SimBus::advanceMicros(uint32_t us){
+    if(pendingBuf){
+        transferUsLeft -= us;
+        if(transferUsLeft <= 0.0){
+            uint8_t *buf = pendingBuf;
+            pendingBuf = nullptr;
+            readRegisters(pendingReg, buf, pendingCount);
+        }
+    }
+    float period = 1000000.0 / (getDataRateHz() * (1.0 + rateErrorPpm / 1000000.0));
+    usAccu += us;
+    uint16_t n = 0;
+    while(usAccu >= period){
+        usAccu -= period;
+        n++;
+    }
+    generateSamples(n);
+}
+
+/* Event interrupts are only latched if enabled. In trigger mode the event on the pin
+   selected by the trigger bit freezes the FIFO history. */
+void ADXL345_SimBus::triggerEvent(adxl345_int type, uint8_t actTapStatus){
+    regs[ADXL345_WE::ADXL345_ACT_TAP_STATUS] = actTapStatus;
+    if(!(regs[ADXL345_WE::ADXL345_INT_ENABLE] & (1<<type))){
+        return;
+    }
+    latchedInt |= (1<<type);
+    if(fifoMode() == ADXL345_TRIGGER && !triggered){
+        bool onInt2 = regs[ADXL345_WE::ADXL345_INT_MAP] & (1<<type);
+        bool triggerOnInt2 = regs[ADXL345_WE::ADXL345_FIFO_CTL] & 0x20;
+        if(onInt2 == triggerOnInt2){
+            triggered = true;
+            while(fifoCount > watermarkLevel()){
+                popSample();
+            }
+        }
+    }
+}
+
+uint8_t ADXL345_SimBus::peekRegister(uint8_t reg){
+    if(reg == ADXL345_WE::ADXL345_INT_SOURCE){
+        return intSource();
+    }
+    if(reg == ADXL345_WE::ADXL345_FIFO_STATUS){
+        return (triggered << 7) | (fifoMode() == ADXL345_BYPASS ? 0 : fifoCount);
+    }
+    if(reg >= ADXL345_WE::ADXL345_DATAX0 && reg <= ADXL345_WE::ADXL345_DATAZ1){
+        const int16_t *val = fifoCount ? fifo[fifoHead] : lastOut;
+        uint16_t word = static_cast<uint16_t>(val[(reg - ADXL345_WE::ADXL345_DATAX0) / 2]);
+        return (reg & 0x01) ? (word >> 8) : (word & 0xFF);
+    }
+    if(reg < ADXL345_SIM_REG_COUNT){
+        return regs[reg];
+    }
+    return 0;
+}
+
+float ADXL345_SimBus::getDataRateHz(){
+    uint8_t rate = regs[ADXL345_WE::ADXL345_BW_RATE] & 0x0F;
+    return ADXL345_WE::dataRateToHz(static_cast<adxl345_dataRate>(rate));
+}
+
+bool ADXL345_SimBus::isInterruptActive(uint8_t pin){
+    uint8_t active = intSource() & regs[ADXL345_WE::ADXL345_INT_ENABLE];
+    uint8_t map = regs[ADXL345_WE::ADXL345_INT_MAP];
+    if(pin == INT_PIN_1){
+        return active & ~map;
+    }
+    return active & map;
+}
+
+uint8_t ADXL345_SimBus::getIntPinLevel(uint8_t pin){
+    bool activeLow = regs[ADXL345_WE::ADXL345_DATA_FORMAT] & 0x20;
+    return (isInterruptActive(pin) != activeLow) ? HIGH : LOW;
+}
+
+void ADXL345_SimBus::resetCounters(){
+    transactions = 0;
+    bytes = 0;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+bool ADXL345_SimBus::isWritable(uint8_t reg){
+    if(reg < ADXL345_WE::ADXL345_THRESH_TAP || reg >= ADXL345_SIM_REG_COUNT){
+        return false;
+    }
+    switch(reg){
+        case ADXL345_WE::ADXL345_ACT_TAP_STATUS:
+        case ADXL345_WE::ADXL345_INT_SOURCE:
+        case ADXL345_WE::ADXL345_FIFO_STATUS:
+            return false;
+        default:
+            return !(reg >= ADXL345_WE::ADXL345_DATAX0 && reg <= ADXL345_WE::ADXL345_DATAZ1);
+    }
+}
+
+uint8_t ADXL345_SimBus::intSource(){
+    uint8_t src = latchedInt;
+    if(fifoCount > 0){
+        src |= (1<<ADXL345_DATA_READY);
+    }
+    if(fifoMode() != ADXL345_BYPASS && fifoCount >= watermarkLevel()){
+        src |= (1<<ADXL345_WATERMARK);
+    }
+    if(overrun){
+        src |= (1<<ADXL345_OVERRUN);
+    }
+    return src;
+}
+
+uint8_t ADXL345_SimBus::readRegister(uint8_t reg){
+    uint8_t val = peekRegister(reg);
+    if(reg == ADXL345_WE::ADXL345_INT_SOURCE){
+        latchedInt = 0;
+    }
+    return val;
+}
+
+void ADXL345_SimBus::addSample(const xyzFloat &g){
+    const float gPerOfs = ADXL345_WE::MILLI_G_PER_OFS_LSB / 1000.0;
+    const xyzFloat ofs(static_cast<int8_t>(regs[ADXL345_WE::ADXL345_OFSX]) * gPerOfs,
+                       static_cast<int8_t>(regs[ADXL345_WE::ADXL345_OFSY]) * gPerOfs,
+                       static_cast<int8_t>(regs[ADXL345_WE::ADXL345_OFSZ]) * gPerOfs);
+    const xyzFloat out = g * errGain + errOffset + ofs;
+    int16_t raw[3] = {toRaw(out.x), toRaw(out.y), toRaw(out.z)};
+    uint8_t capacity = ADXL345_SIM_FIFO_DEPTH;
+    switch(fifoMode()){
+        case ADXL345_BYPASS:
+            capacity = 1;
+            break;
+        case ADXL345_FIFO:
+            if(fifoCount == capacity){
+                overrun = true;
+                return;
+            }
+            break;
+        case ADXL345_TRIGGER:
+            if(triggered && fifoCount == capacity){
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    if(fifoCount == capacity){
+        overrun = true;
+        fifoHead = (fifoHead + 1) % ADXL345_SIM_FIFO_DEPTH;
+        fifoCount--;
+    }
+    uint8_t tail = (fifoHead + fifoCount) % ADXL345_SIM_FIFO_DEPTH;
+    for(int i=0; i<3; i++){
+        fifo[tail][i] = raw[i];
+    }
+    fifoCount++;
+}
+
+void ADXL345_SimBus::popSample(){
+    if(fifoCount == 0){
+        return;
+    }
+    for(int i=0; i<3; i++){
+        lastOut[i] = fifo[fifoHead][i];
+    }
+    fifoHead = (fifoHead + 1) % ADXL345_SIM_FIFO_DEPTH;
+    fifoCount--;
+    overrun = false;
+}
+
+/* Full resolution: 3.9 mg/LSB up to the selected range, otherwise 10 bit over the range */
+int16_t ADXL345_SimBus::toRaw(float g){
+    uint8_t format = regs[ADXL345_WE::ADXL345_DATA_FORMAT];
+    uint8_t range = format & 0x03;
+    bool fullRes = format & (1<<ADXL345_WE::ADXL345_FULL_RES);
+    float lsb = ADXL345_WE::MILLI_G_PER_LSB / 1000.0;
+    int32_t limit = 512L << (fullRes ? range : 0);
+    if(!fullRes){
+        lsb *= (1 << range);
+    }
+    int32_t raw = static_cast<int32_t>(round(g / lsb));
+    if(raw > limit - 1){
+        raw = limit - 1;
+    }
+    else if(raw < -limit){
+        raw = -limit;
+    }
+    return static_cast<int16_t>(raw);
+}
+
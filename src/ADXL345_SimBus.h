@@ -0,0 +1,104 @@
+/******************************************************************************
+ *
+ * Software model of the ADXL345 / ADXL343 for the ADXL345_WE library.
+ *
+ * ADXL345_SimBus is an ADXL345_Bus which emulates the register map
+ * 0x00 - 0x39, the data format (range, full resolution), the offset
+ * registers, the FIFO modes and the interrupt source behavior. Pass it to
+ * the ADXL345_WE constructor to run the driver without hardware, e.g. on a
+ * Linux host. Samples are produced by advanceMicros() / generateSamples()
+ * from a constant acceleration or from a sample source callback (e.g.
+ * recorded data).
+ *
+ * The model counts the bus transactions and bytes (register address +
+ * data) it has seen.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_SIMBUS_H_
+#define ADXL345_SIMBUS_H_
+
+#include "ADXL345_WE.h"
+
+/* Delivers the next acceleration in g. Return false if there is no more data, then the
+   last value is held. */
+typedef bool (*adxl345_simSource)(void *context, xyzFloat *gVal);
+
+class ADXL345_SimBus : public ADXL345_Bus
+{
+    public:
+        static constexpr uint8_t ADXL345_SIM_REG_COUNT  {0x3A};
+        static constexpr uint8_t ADXL345_SIM_FIFO_DEPTH {32};
+
+        ADXL345_SimBus() { reset(); }
+
+        void reset();
+        bool writeRegisters(uint8_t reg, const uint8_t *buf, uint8_t count) override;
+        bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        bool startReadRegisters(uint8_t reg, uint8_t *buf, uint8_t count) override;
+        bool isTransferDone() override { return !pendingBuf; }
+
+        /* Stimulus */
+        void setAcceleration(const xyzFloat &g);
+        void setSampleSource(adxl345_simSource src, void *context);
+        void generateSamples(uint16_t n);
+        void advanceMicros(uint32_t us);
+        void triggerEvent(adxl345_int type, uint8_t actTapStatus = 0);
+        /* Non-blocking reads take usPerByte (address + data) of simulated time, 0 = not supported */
+        void setTransferTime(float usPerByte) { transferUsPerByte = usPerByte; }
+        /* Deviation of the true data rate from the nominal one, like a real oscillator */
+        void setDataRateError(float ppm) { rateErrorPpm = ppm; }
+        /* Sensor error like an uncalibrated device: output = gain * g + offset (in g) */
+        void setSensorError(const xyzFloat &offset, const xyzFloat &gain) { errOffset = offset; errGain = gain; }
+
+        /* Inspection without side effects */
+        uint8_t peekRegister(uint8_t reg);
+        uint8_t getFifoEntries() { return fifoCount; }
+        float getDataRateHz();
+        bool isInterruptActive(uint8_t pin);
+        uint8_t getIntPinLevel(uint8_t pin);
+
+        /* Counters */
+        uint32_t getTransactions() { return transactions; }
+        uint32_t getBytes() { return bytes; }
+        void resetCounters();
+
+    protected:
+        uint8_t regs[ADXL345_SIM_REG_COUNT];
+        int16_t fifo[ADXL345_SIM_FIFO_DEPTH][3];
+        int16_t lastOut[3];
+        uint8_t fifoHead;
+        uint8_t fifoCount;
+        uint8_t latchedInt;     // event interrupts, cleared by reading INT_SOURCE
+        bool overrun;
+        bool triggered;
+        xyzFloat accel;
+        adxl345_simSource source;
+        void *sourceContext;
+        float usAccu;
+        float rateErrorPpm;
+        xyzFloat errOffset;
+        xyzFloat errGain;
+        uint32_t transactions;
+        uint32_t bytes;
+        float transferUsPerByte;
+        float transferUsLeft;
+        uint8_t pendingReg;
+        uint8_t *pendingBuf;
+        uint8_t pendingCount;
+        bool isWritable(uint8_t reg);
+        uint8_t fifoMode() { return regs[ADXL345_WE::ADXL345_FIFO_CTL] >> 6; }
+        uint8_t watermarkLevel() { return regs[ADXL345_WE::ADXL345_FIFO_CTL] & 0x1F; }
+        uint8_t intSource();
+        uint8_t readRegister(uint8_t reg);
+        void addSample(const xyzFloat &g);
+        void popSample();
+        int16_t toRaw(float g);
+};
+
+#endif
+
@@ -0,0 +1,51 @@
+/********************************************************************
+* Instrumentation for the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include "ADXL345_Stats.h"
+
+/************ ADXL345_Histogram ************/
+
+void ADXL345_Histogram::add(uint32_t us){
+    uint8_t bin = 0;
+    uint32_t limit = 16;
+    while(bin < ADXL345_HIST_BINS - 1 && us >= limit){
+        bin++;
+        limit <<= 1;
+    }
+    bins[bin]++;
+    if(us > maxVal){
+        maxVal = us;
+    }
+}
+
+void ADXL345_Histogram::reset(){
+    for(int i=0; i<ADXL345_HIST_BINS; i++){
+        bins[i] = 0;
+    }
+    maxVal = 0;
+}
+
+uint32_t ADXL345_Histogram::getUpperLimit(uint8_t bin){
+    if(bin >= ADXL345_HIST_BINS - 1){
+        return 0;
+    }
+    return 16UL << bin;
+}
+
+/************ ADXL345_Stats ************/
+
+void ADXL345_Stats::reset(){
+    transactions = 0;
+    bytes = 0;
+    busErrors = 0;
+    fifoOverruns = 0;
+    samplesDrained = 0;
+    transactionMicros.reset();
+    watermarkLatencyMicros.reset();
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ *
+ * Instrumentation for the ADXL345_WE library.
+ *
+ * If ADXL345_ENABLE_STATS is defined (see ADXL345_Options.h), each
+ * ADXL345_WE object keeps an ADXL345_Stats block. It counts the bus
+ * transactions, bytes (register address + data), failed transactions
+ * (NACK, short read), FIFO overruns seen in INT_SOURCE and the samples
+ * drained from the FIFO. Two histograms show the duration of the bus
+ * accesses (a FIFO drain counts as one access) and the latency from the
+ * watermark interrupt to the drain. getStats() returns nullptr if the
+ * option is not enabled, and the driver contains no instrumentation code.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_STATS_H_
+#define ADXL345_STATS_H_
+
+#include <stdint.h>
+
+/* Bin i counts values below 2^(i+4) µs, i.e. < 16 µs, < 32 µs, ... < 16384 µs. The last
+   bin counts everything from 16384 µs. */
+class ADXL345_Histogram
+{
+    public:
+        static constexpr uint8_t ADXL345_HIST_BINS {12};
+
+        void add(uint32_t us);
+        void reset();
+        uint32_t getBin(uint8_t bin) const { return (bin < ADXL345_HIST_BINS) ? bins[bin] : 0; }
+        static uint32_t getUpperLimit(uint8_t bin);   // exclusive, 0 = open end
+        uint32_t getMax() const { return maxVal; }
+
+    protected:
+        uint32_t bins[ADXL345_HIST_BINS] = {0};
+        uint32_t maxVal = 0;
+};
+
+struct ADXL345_Stats
+{
+    uint32_t transactions = 0;
+    uint32_t bytes = 0;
+    uint32_t busErrors = 0;
+    uint32_t fifoOverruns = 0;
+    uint32_t samplesDrained = 0;
+    ADXL345_Histogram transactionMicros;
+    ADXL345_Histogram watermarkLatencyMicros;
+    
+    void reset();
+};
+
+#endif
@@ -0,0 +1,86 @@
+/********************************************************************
+* Time stamps for FIFO samples of the ADXL345_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include "ADXL345_Timebase.h"
+
+static constexpr float PHASE_GAIN      {0.02};    // share of the error applied to the phase
+static constexpr float PERIOD_GAIN     {0.0001};  // share of the error per sample applied to the period
+static constexpr float MAX_PERIOD_DEV  {0.1};     // max. deviation of the period from nominal
+static constexpr float RESYNC_PERIODS  {8.0};     // phase errors above this restart the loop
+
+void ADXL345_Timebase::reset(float nominalHz){
+    nominalPeriod = (nominalHz > 0.0) ? 1000000.0 / nominalHz : 0.0;
+    period = nominalPeriod;
+    carried = 0;
+    locked = false;
+    drains = 0;
+}
+
+void ADXL345_Timebase::stamp(uint32_t drainMicros, uint8_t fifoEntries, uint8_t delivered, 
+                             uint32_t *timestamps){
+    if(!isStarted() || fifoEntries == 0){
+        return;
+    }
+    uint8_t fresh = (fifoEntries > carried) ? fifoEntries - carried : 0;
+    /* On average the drain comes half a period after the newest sample */
+    float observed = static_cast<int32_t>(drainMicros - lastSample) - lastFrac - period / 2;
+    float predicted = fresh * period;
+    float err = observed - predicted;
+    bool overflow = (fifoEntries >= ADXL345_TB_FIFO_FULL);
+    if(!locked || overflow || err > RESYNC_PERIODS * period || err < -RESYNC_PERIODS * period){
+        if(locked){
+            resyncs++;
+        }
+        predicted = observed;
+        err = 0.0;
+        locked = true;
+        drains = 0;
+    }
+    /* After a (re)start, the gains begin wide and narrow down with each drain like those of a least
+       squares fit of a line, until they reach their final values */
+    float phaseGain = PHASE_GAIN;
+    float periodGain = PERIOD_GAIN;
+    if(drains < UINT8_MAX){
+        drains++;
+        float n = drains;
+        float fitGain = 2 * (2 * n - 1) / (n * (n + 1));
+        if(fitGain > PHASE_GAIN){
+            phaseGain = fitGain;
+            periodGain = 6 / (n * (n + 1));
+        }
+        else{
+            drains = UINT8_MAX;
+        }
+    }
+    if(err != 0.0 && fresh > 0){
+        period += periodGain * err / fresh;
+        if(period > nominalPeriod * (1 + MAX_PERIOD_DEV)){
+            period = nominalPeriod * (1 + MAX_PERIOD_DEV);
+        }
+        else if(period < nominalPeriod * (1 - MAX_PERIOD_DEV)){
+            period = nominalPeriod * (1 - MAX_PERIOD_DEV);
+        }
+    }
+    /* Time of the newest sample in the FIFO, relative to the previous newest sample */
+    float newest = lastFrac + predicted + phaseGain * err;
+    if(newest < 0.0){
+        newest = 0.0;   // time stamps never go backwards
+    }
+    uint32_t newestWhole = static_cast<uint32_t>(newest);
+    uint32_t base = lastSample + newestWhole;
+    float baseFrac = newest - newestWhole;
+    for(int i=0; i<delivered; i++){
+        float back = (fifoEntries - 1 - i) * period - baseFrac;
+        timestamps[i] = base - lround(back);
+    }
+    lastSample = base;
+    lastFrac = baseFrac;
+    carried = fifoEntries - delivered;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+ *
+ * Time stamps for FIFO samples of the ADXL345_WE library.
+ *
+ * The FIFO does not store when a sample was taken. ADXL345_Timebase
+ * reconstructs it from the time of the drain, the FIFO fill level and the
+ * sample period. The true data rate of the ADXL345 differs from the
+ * nominal one by up to a few percent. Therefore the period is estimated
+ * from the drain history with a second order tracking loop: the newest
+ * sample of a drain is predicted from the previous one, and the difference
+ * to the drain time corrects the phase and the period. After a start, the
+ * loop settles within a few dozen drains like a least squares fit and then
+ * narrows down to suppress the jitter of the drain times. This way long
+ * captures don't accumulate drift.
+ *
+ * The drain has to happen less than one period after the newest sample
+ * on average (e.g. in the watermark interrupt or regularly from loop()).
+ * If the FIFO was full, samples may be lost and the loop resynchronizes.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_TIMEBASE_H_
+#define ADXL345_TIMEBASE_H_
+
+#include <stdint.h>
+
+class ADXL345_Timebase
+{
+    public:
+        static constexpr uint8_t ADXL345_TB_FIFO_FULL {32};
+
+        void reset(float nominalHz);
+        bool isStarted() { return nominalPeriod > 0.0; }
+        /* fifoEntries: number of entries in FIFO_STATUS when the drain started, delivered: entries
+           read. timestamps receives one value in micros() per delivered entry, oldest first. */
+        void stamp(uint32_t drainMicros, uint8_t fifoEntries, uint8_t delivered, uint32_t *timestamps);
+
+        float getDataRateHz() { return (period > 0.0) ? 1000000.0 / period : 0.0; }
+        float getDriftPpm() { return (period > 0.0) ? (nominalPeriod / period - 1.0) * 1000000.0 : 0.0; }
+        uint32_t getResyncs() { return resyncs; }
+
+    protected:
+        float nominalPeriod = 0.0;  // µs
+        float period = 0.0;         // µs, estimated
+        uint32_t lastSample = 0;    // time stamp of the newest sample so far
+        float lastFrac = 0.0;       // fractional µs of lastSample
+        uint8_t carried = 0;        // entries left in the FIFO by the last drain
+        bool locked = false;
+        uint8_t drains = 0;         // drains since the last (re)start, up to the end of the start phase
+        uint32_t resyncs = 0;
+};
+
+#endif
@@ -0,0 +1,241 @@
+/********************************************************************
+* Vibration analysis for the ADXL345_WE / ADXL343_WE library.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#include <math.h>
+#include "ADXL345_Vibration.h"
+
+static constexpr uint16_t MIN_WINDOW {16};
+static constexpr uint16_t MAX_WINDOW {4096};
+static constexpr float TWO_PI_F      {6.2831853};
+
+bool ADXL345_Vibration::begin(float sampleRateHz, adxl345_vibAxis axis){
+    sampleRate = 0.0;
+    fill = 0;
+    featuresValid = false;
+    spectrumValid = false;
+    features.window = 0;
+    if(!buf || size < MIN_WINDOW || size > MAX_WINDOW || (size & (size - 1)) || sampleRateHz <= 0.0){
+        return false;
+    }
+    sampleRate = sampleRateHz;
+    fftAxis = axis;
+    bandCount = ADXL345_VIB_MAX_BANDS;
+    for(uint8_t i=0; i<=bandCount; i++){
+        edges[i] = sampleRate / 2 * i / bandCount;
+    }
+    edges[bandCount] += getBinHz();   // the last band includes fs/2
+    return true;
+}
+
+bool ADXL345_Vibration::setBands(const float *edgesHz, uint8_t bands){
+    if(bands == 0 || bands > ADXL345_VIB_MAX_BANDS){
+        return false;
+    }
+    for(uint8_t i=0; i<bands; i++){
+        if(edgesHz[i+1] <= edgesHz[i]){
+            return false;
+        }
+    }
+    for(uint8_t i=0; i<=bands; i++){
+        edges[i] = edgesHz[i];
+    }
+    bandCount = bands;
+    return true;
+}
+
+uint8_t ADXL345_Vibration::addSamples(const xyzInt16 *rawVal, uint16_t n){
+    if(sampleRate == 0.0){
+        return 0;
+    }
+    uint8_t windows = 0;
+    for(uint16_t i=0; i<n; i++){
+        const xyzInt16 &r = rawVal[i];
+        if(fill == 0){
+            startWindow(r);
+        }
+        const int16_t v[3] = {r.x, r.y, r.z};
+        for(int axis=0; axis<3; axis++){
+            int32_t d = static_cast<int32_t>(v[axis]) - ref[axis];
+            sum[axis] += d;
+            sumSq[axis] += static_cast<float>(d) * d;
+            if(v[axis] < minVal[axis]){
+                minVal[axis] = v[axis];
+            }
+            if(v[axis] > maxVal[axis]){
+                maxVal[axis] = v[axis];
+            }
+        }
+        switch(fftAxis){
+            case ADXL345_VIB_X: buf[fill] = (r.x - offset.x) * factor.x; break;
+            case ADXL345_VIB_Y: buf[fill] = (r.y - offset.y) * factor.y; break;
+            case ADXL345_VIB_Z: buf[fill] = (r.z - offset.z) * factor.z; break;
+            case ADXL345_VIB_MAGNITUDE: {
+                xyzFloat g((r.x - offset.x) * factor.x, (r.y - offset.y) * factor.y, (r.z - offset.z) * factor.z);
+                buf[fill] = sqrt(g.x * g.x + g.y * g.y + g.z * g.z);
+                break;
+            }
+        }
+        if(++fill == size){
+            finishWindow();
+            fill = 0;
+            windows++;
+        }
+    }
+    return windows;
+}
+
+bool ADXL345_Vibration::getFeatures(adxl345_vibFeatures *feat){
+    if(!featuresValid){
+        return false;
+    }
+    *feat = features;
+    return true;
+}
+
+/************************************************
+    private functions
+*************************************************/
+
+void ADXL345_Vibration::startWindow(const xyzInt16 &first){
+    adxl->getScaling(&offset, &factor);
+    const int16_t v[3] = {first.x, first.y, first.z};
+    for(int axis=0; axis<3; axis++){
+        ref[axis] = v[axis];
+        sum[axis] = 0;
+        sumSq[axis] = 0.0;
+        minVal[axis] = v[axis];
+        maxVal[axis] = v[axis];
+    }
+    spectrumValid = false;
+}
+
+void ADXL345_Vibration::finishWindow(){
+    /* Time domain features per axis */
+    const float fac[3] = {fabs(factor.x), fabs(factor.y), fabs(factor.z)};
+    float rms[3], peak[3], crest[3];
+    for(int axis=0; axis<3; axis++){
+        float mean = static_cast<float>(sum[axis]) / size;
+        float var = sumSq[axis] / size - mean * mean;
+        rms[axis] = (var > 0.0) ? sqrt(var) * fac[axis] : 0.0;
+        mean += ref[axis];
+        float dev = (maxVal[axis] - mean > mean - minVal[axis]) ? maxVal[axis] - mean : mean - minVal[axis];
+        peak[axis] = dev * fac[axis];
+        crest[axis] = (rms[axis] > 0.0) ? peak[axis] / rms[axis] : 0.0;
+    }
+    features.rms = xyzFloat(rms[0], rms[1], rms[2]);
+    features.peak = xyzFloat(peak[0], peak[1], peak[2]);
+    features.crest = xyzFloat(crest[0], crest[1], crest[2]);
+
+    /* Spectrum: remove the mean, Hann window, FFT */
+    float mean = 0.0;
+    for(uint16_t i=0; i<size; i++){
+        mean += buf[i];
+    }
+    mean /= size;
+    for(uint16_t i=0; i<size; i++){
+        buf[i] = (buf[i] - mean) * 0.5 * (1.0 - cos(TWO_PI_F * i / size));
+    }
+    fft();
+
+    /* Amplitudes, sum of the Hann window = size / 2. The energy of a bin is amp^2 / 3, so that
+       the bins of a sine (main lobe 1, 1/2, 1/2) add up to amp^2 / 2. */
+    const uint16_t half = size / 2;
+    features.dominantHz = 0.0;
+    features.dominantAmp = 0.0;
+    features.bands = bandCount;
+    float energy[ADXL345_VIB_MAX_BANDS] = {0};
+    for(uint16_t k=0; k<=half; k++){
+        float amp = buf[k] * ((k == 0 || k == half) ? 2.0 : 4.0) / size;
+        buf[k] = amp;
+        float hz = k * getBinHz();
+        if(k > 0 && amp > features.dominantAmp){
+            features.dominantAmp = amp;
+            features.dominantHz = hz;
+        }
+        for(uint8_t b=0; b<bandCount; b++){
+            if(hz >= edges[b] && hz < edges[b+1]){
+                energy[b] += amp * amp / 3.0;
+                break;
+            }
+        }
+    }
+    for(uint8_t b=0; b<bandCount; b++){
+        features.bandRms[b] = sqrt(energy[b]);
+    }
+    spectrumValid = true;
+    featuresValid = true;
+    if(callback){
+        callback(cbContext, features);
+    }
+    features.window++;
+}
+
+/* Real FFT of size values: an FFT of size/2 complex values (even and odd samples), then the
+   split into the spectrum of the real signal. The magnitudes of bins 0 ... size/2 are left in
+   buf[0] ... buf[size/2]. */
+void ADXL345_Vibration::fft(){
+    const uint16_t m = size / 2;
+    float *z = buf;
+    for(uint16_t i=1, j=0; i<m; i++){   // bit reversal
+        uint16_t bit = m >> 1;
+        for(; j & bit; bit >>= 1){
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j){
+            float t = z[2*i];
+            z[2*i] = z[2*j];
+            z[2*j] = t;
+            t = z[2*i+1];
+            z[2*i+1] = z[2*j+1];
+            z[2*j+1] = t;
+        }
+    }
+    for(uint16_t len=2; len<=m; len<<=1){
+        const uint16_t halfLen = len / 2;
+        for(uint16_t k=0; k<halfLen; k++){
+            float wRe = cos(TWO_PI_F * k / len);
+            float wIm = -sin(TWO_PI_F * k / len);
+            for(uint16_t s=0; s<m; s+=len){
+                float *a = z + 2*(s + k);
+                float *b = z + 2*(s + k + halfLen);
+                float tRe = b[0] * wRe - b[1] * wIm;
+                float tIm = b[0] * wIm + b[1] * wRe;
+                b[0] = a[0] - tRe;
+                b[1] = a[1] - tIm;
+                a[0] += tRe;
+                a[1] += tIm;
+            }
+        }
+    }
+
+    /* X[k] = Fe + W^k * Fo, X[m-k] = conj(Fe - W^k * Fo), W = exp(-2 pi i / size). The magnitudes
+       of a pair go to the real parts of its own slots, then they are moved together. */
+    const float dc = fabs(z[0] + z[1]);
+    const float nyquist = fabs(z[0] - z[1]);
+    for(uint16_t k=1; k<=m/2; k++){
+        float *zk = z + 2*k;
+        float *zmk = z + 2*(m - k);
+        float feRe = 0.5 * (zk[0] + zmk[0]);
+        float feIm = 0.5 * (zk[1] - zmk[1]);
+        float foRe = 0.5 * (zk[1] + zmk[1]);
+        float foIm = -0.5 * (zk[0] - zmk[0]);
+        float wRe = cos(TWO_PI_F * k / size);
+        float wIm = -sin(TWO_PI_F * k / size);
+        float tRe = wRe * foRe - wIm * foIm;
+        float tIm = wRe * foIm + wIm * foRe;
+        zk[0] = sqrt((feRe + tRe) * (feRe + tRe) + (feIm + tIm) * (feIm + tIm));
+        zmk[0] = sqrt((feRe - tRe) * (feRe - tRe) + (feIm - tIm) * (feIm - tIm));
+    }
+    z[0] = dc;
+    for(uint16_t k=1; k<m; k++){
+        z[k] = z[2*k];
+    }
+    z[m] = nyquist;
+}
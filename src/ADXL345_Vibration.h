@@ -0,0 +1,101 @@
+/******************************************************************************
+ *
+ * Vibration analysis for the ADXL345_WE library.
+ *
+ * ADXL345_Vibration collects raw values, e.g. from readFifo(), in windows
+ * of a fixed size. For each window it calculates a compact feature record
+ * instead of passing on all samples:
+ *
+ *   - RMS, peak and crest factor (peak / RMS) per axis, without the mean
+ *     (i.e. without gravity)
+ *   - the spectrum of one axis or of the magnitude: real FFT with a Hann
+ *     window, the dominant frequency and the energy in up to
+ *     ADXL345_VIB_MAX_BANDS frequency bands
+ *
+ * The FFT works in place in a buffer of windowSize floats which you pass to
+ * the constructor, windowSize has to be a power of 2 (16 ... 4096). After a
+ * window is complete, the buffer holds the amplitude spectrum (g) until the
+ * next sample is added: windowSize / 2 + 1 values, bin i is at
+ * i * getBinHz(). RMS, peak and crest factor need no buffer.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_VIBRATION_H_
+#define ADXL345_VIBRATION_H_
+
+#include "ADXL345_WE.h"
+
+typedef enum ADXL345_VIB_AXIS {
+    ADXL345_VIB_X, ADXL345_VIB_Y, ADXL345_VIB_Z, ADXL345_VIB_MAGNITUDE,
+    ADXL343_VIB_X         = ADXL345_VIB_X,
+    ADXL343_VIB_Y         = ADXL345_VIB_Y,
+    ADXL343_VIB_Z         = ADXL345_VIB_Z,
+    ADXL343_VIB_MAGNITUDE = ADXL345_VIB_MAGNITUDE
+} adxl345_vibAxis;
+
+static constexpr uint8_t ADXL345_VIB_MAX_BANDS {8};
+
+/* All values in g, frequencies in Hz */
+typedef struct ADXL345_VIBRATION_FEATURES {
+    uint32_t window;            // number of the window, starting with 0
+    xyzFloat rms;
+    xyzFloat peak;              // max. deviation from the mean
+    xyzFloat crest;             // peak / rms, 0 if rms is 0
+    float dominantHz;           // spectrum maximum (without DC)
+    float dominantAmp;          // its amplitude
+    uint8_t bands;
+    float bandRms[ADXL345_VIB_MAX_BANDS];  // sqrt of the energy per band
+} adxl345_vibFeatures;
+
+typedef void (*adxl345_vibCallback)(void *context, const adxl345_vibFeatures &features);
+
+class ADXL345_Vibration
+{
+    public:
+        ADXL345_Vibration(ADXL345_WE *acc, float *fftBuffer, uint16_t windowSize)
+            : adxl{acc}, buf{fftBuffer}, size{windowSize} {}
+
+        bool begin(float sampleRateHz, adxl345_vibAxis axis = ADXL345_VIB_Z);
+        /* edgesHz: bands + 1 ascending frequencies. Default: 8 bands of equal width up to fs/2. */
+        bool setBands(const float *edgesHz, uint8_t bands);
+        void setCallback(adxl345_vibCallback cb, void *context = nullptr) { callback = cb; cbContext = context; }
+
+        /* Returns the number of windows completed in this call */
+        uint8_t addSamples(const xyzInt16 *rawVal, uint16_t n);
+        bool getFeatures(adxl345_vibFeatures *features);    // last complete window
+        const float* getSpectrum() { return spectrumValid ? buf : nullptr; }
+        float getBinHz() { return sampleRate / size; }
+
+    protected:
+        ADXL345_WE *adxl;
+        float *buf;
+        uint16_t size;
+        float sampleRate = 0.0;
+        adxl345_vibAxis fftAxis = ADXL345_VIB_Z;
+        float edges[ADXL345_VIB_MAX_BANDS + 1];
+        uint8_t bandCount = 0;
+        adxl345_vibCallback callback = nullptr;
+        void *cbContext = nullptr;
+        /* current window */
+        uint16_t fill = 0;
+        xyzFloat offset;            // scaling of the ADXL345_WE object at the start of the window
+        xyzFloat factor;
+        int16_t ref[3];             // first value, keeps the sums small
+        int32_t sum[3];
+        float sumSq[3];
+        int16_t minVal[3];
+        int16_t maxVal[3];
+        /* results */
+        adxl345_vibFeatures features;
+        bool featuresValid = false;
+        bool spectrumValid = false;
+        void startWindow(const xyzInt16 &first);
+        void finishWindow();
+        void fft();
+};
+
+#endif
@@ -16,64 +16,212 @@
 
 #include "ADXL345_WE.h"
 
-/************ Basic settings ************/
-    
-bool ADXL345_WE::init(){    
-    if(useSPI){
-        if(mosiPin == 999){
-            _spi->begin();
+/************ ADXL345_Snapshot ************/
+
+/* All functions of the snapshot are calculated from the stored g values without bus access */
+
+xyzFloat ADXL345_Snapshot::getAngles() const{
+    xyzFloat angleVal;
+    angleVal.x = asinDeg(gVal.x, trigMode);
+    angleVal.y = asinDeg(gVal.y, trigMode);
+    angleVal.z = asinDeg(gVal.z, trigMode);
+    return angleVal;
+}
+
+xyzFloat ADXL345_Snapshot::getCorrAngles() const{
+    return getAngles() - angleOffsetVal;
+}
+
+adxl345_orientation ADXL345_Snapshot::getOrientation() const{
+    adxl345_orientation orientation = FLAT;
+    xyzFloat angleVal = getAngles();
+    if(abs(angleVal.x) < 45){      // |x| < 45
+        if(abs(angleVal.y) < 45){      // |y| < 45
+            if(angleVal.z > 0){          //  z  > 0
+                orientation = FLAT;
+            }
+            else{                        //  z  < 0
+                orientation = FLAT_1;
+            }
         }
-#ifdef ESP32
-        else{
-            _spi->begin(sckPin, misoPin, mosiPin, csPin);
+        else{                         // |y| > 45 
+            if(angleVal.y > 0){         //  y  > 0
+                orientation = XY;
+            }
+            else{                       //  y  < 0
+                orientation = XY_1;   
+            }
         }
-#endif
-#ifdef ARDUINO_ARCH_STM32
-    else {
-       _spi->setMISO(misoPin);
-       _spi->setMOSI(mosiPin);
-       _spi->setSCLK(sckPin);
-       _spi->begin();
     }
-#endif
-        setSPIClockSpeed(spiClock);
-        pinMode(csPin, OUTPUT);
-        digitalWrite(csPin, HIGH);
+    else{                           // |x| >= 45
+        if(angleVal.x > 0){           //  x  >  0
+            orientation = YX;       
+        }
+        else{                       //  x  <  0
+            orientation = YX_1;
+        }
+    }
+    return orientation;
+}
+
+float ADXL345_Snapshot::getPitch() const{
+    float pitch, roll;
+    getPitchRoll(&pitch, &roll);
+    return pitch;
+}
+    
+float ADXL345_Snapshot::getRoll() const{
+    float pitch, roll;
+    getPitchRoll(&pitch, &roll);
+    return roll;
+}
+
+/* The fixed point variant works with g values in Q14 format. Beyond 2 g all three are scaled 
+   down until they fit into 15 bits, so that y^2 + z^2 fits into 32 bits. */
+void ADXL345_Snapshot::getPitchRoll(float *pitch, float *roll) const{
+    switch(trigMode){
+        case ADXL345_TRIG_FAST:
+            *pitch = adxl345_fastAtan2Deg(-gVal.x, sqrtf(gVal.y*gVal.y + gVal.z*gVal.z));
+            *roll = adxl345_fastAtan2Deg(gVal.y, gVal.z);
+            break;
+        case ADXL345_TRIG_FIXED:{
+            int32_t x = static_cast<int32_t>(gVal.x * 16384);
+            int32_t y = static_cast<int32_t>(gVal.y * 16384);
+            int32_t z = static_cast<int32_t>(gVal.z * 16384);
+            while(x > 0x7FFF || x < -0x7FFF || y > 0x7FFF || y < -0x7FFF || z > 0x7FFF || z < -0x7FFF){
+                x /= 2;
+                y /= 2;
+                z /= 2;
+            }
+            uint32_t yz = adxl345_isqrt(static_cast<uint32_t>(y*y) + static_cast<uint32_t>(z*z));
+            *pitch = adxl345_atan2Fixed(-x, yz) / 100.0;
+            *roll = adxl345_atan2Fixed(y, z) / 100.0;
+            break;
+        }
+        default:
+            *pitch = (atan2(-gVal.x, sqrt(abs((gVal.y*gVal.y + gVal.z*gVal.z))))*180.0)/M_PI;
+            *roll = (atan2(gVal.y, gVal.z)*180.0)/M_PI;
+            break;
+    }
+}
+
+float ADXL345_Snapshot::asinDeg(float val, adxl345_trigMode mode){
+    if(val > 1){
+        val = 1;
+    }
+    else if(val < -1){
+        val = -1;
+    }
+    switch(mode){
+        case ADXL345_TRIG_FAST:
+            return adxl345_fastAsinDeg(val);
+        case ADXL345_TRIG_FIXED:
+            return adxl345_asinFixed(static_cast<int32_t>(val * 16384), 16384) / 100.0;
+        default:
+            return (asin(val)) * 57.296;
+    }
+}
+
+/************ Basic settings ************/
+    
+/* All writable registers are set to their defaults with a few burst writes (see applyConfig()).
+   Offsets, activity / free fall thresholds and the data rate are reset, too. */
+bool ADXL345_WE::init(){    
+    regCacheValid = false;
+    if(!activeBus()->begin()){
+        return false;
     }
     writeRegister(ADXL345_POWER_CTL, 0);
-    writeRegister(ADXL345_POWER_CTL, 16);   
-    setMeasureMode(true);
-    rangeFactor = 1.0;
     corrFact = {1.0, 1.0, 1.0};
     offsetVal = {0.0, 0.0, 0.0};
+    hwOffsetEnabled = false;
     angleOffsetVal = {0.0, 0.0, 0.0};
-    writeRegister(ADXL345_DATA_FORMAT,0); 
-    setFullRes(true); 
+    adxl345_config defaultConfig;
+    applyConfig(defaultConfig);
     uint8_t ctrlVal; 
     bool ok = readRegister8(ADXL345_DATA_FORMAT, &ctrlVal);
     if(!ok || ctrlVal != 0b1000){
         return false;
     }
-    writeRegister(ADXL345_INT_ENABLE, 0);
-    writeRegister(ADXL345_INT_MAP,0);
-    writeRegister(ADXL345_TIME_INACT, 0);
-    writeRegister(ADXL345_THRESH_INACT,0);
-    writeRegister(ADXL345_ACT_INACT_CTL, 0);
-    writeRegister(ADXL345_DUR,0);
-    writeRegister(ADXL345_LATENT,0);
-    writeRegister(ADXL345_THRESH_TAP,0);
-    writeRegister(ADXL345_TAP_AXES,0);
-    writeRegister(ADXL345_WINDOW, 0);
     readAndClearInterrupts();
-    writeRegister(ADXL345_FIFO_CTL,0);
-    writeRegister(ADXL345_FIFO_STATUS,0);
+    if(regCacheEnabled){
+        return syncRegisterCache();
+    }
      
     return true;
 }
 
+/* Writes the complete configuration with four bus transactions: the threshold block 0x1D-0x2A, 
+   DATA_FORMAT, FIFO_CTL and finally the block 0x2C-0x2F (rate, power, interrupts), so that 
+   measurement starts with everything else in place. */
+void ADXL345_WE::applyConfig(const adxl345_config &cfg){
+    uint8_t block[ADXL345_TAP_AXES - ADXL345_THRESH_TAP + 1] = {
+        cfg.threshTap, cfg.ofsX, cfg.ofsY, cfg.ofsZ, cfg.dur, cfg.latent, cfg.window, cfg.threshAct, 
+        cfg.threshInact, cfg.timeInact, cfg.actInactCtl, cfg.threshFF, cfg.timeFF, cfg.tapAxes
+    };
+    for(int i=0; i<3; i++){
+        if(hwOffsetEnabled){    // the offsets of enableHardwareOffsets() take precedence over cfg
+            block[ADXL345_OFSX - ADXL345_THRESH_TAP + i] = static_cast<uint8_t>(hwOffset[i]);
+        }
+        else{
+            hwOffset[i] = 0;
+        }
+    }
+    writeMultipleRegisters(ADXL345_THRESH_TAP, sizeof(block), block);
+    writeRegister(ADXL345_DATA_FORMAT, cfg.dataFormat);
+    writeRegister(ADXL345_FIFO_CTL, cfg.fifoCtl);
+    uint8_t ctlBlock[ADXL345_INT_MAP - ADXL345_BW_RATE + 1] = {
+        cfg.bwRate, cfg.powerCtl, cfg.intEnable, cfg.intMap
+    };
+    writeMultipleRegisters(ADXL345_BW_RATE, sizeof(ctlBlock), ctlBlock);
+    adxl345_lowRes = !(cfg.dataFormat & (1<<ADXL345_FULL_RES));
+    updateRangeFactor(adxl345_range(cfg.dataFormat & 0x03));
+    resetTimestamps();
+}
+
+/* Reads the complete configuration with three bus transactions, or from the register cache */
+bool ADXL345_WE::getConfig(adxl345_config *cfg){
+    uint8_t block[ADXL345_INT_MAP - ADXL345_THRESH_TAP + 1];
+    if(regCacheValid){
+        for(uint8_t i=0; i<sizeof(block); i++){
+            block[i] = regCache[i];
+        }
+    }
+    else if (!readMultipleRegisters(ADXL345_THRESH_TAP, sizeof(block), block)) {
+        return false;
+    }
+    if (!readRegister8(ADXL345_DATA_FORMAT, &cfg->dataFormat) || !readRegister8(ADXL345_FIFO_CTL, &cfg->fifoCtl)) {
+        return false;
+    }
+    cfg->threshTap   = block[ADXL345_THRESH_TAP - ADXL345_THRESH_TAP];
+    cfg->ofsX        = block[ADXL345_OFSX - ADXL345_THRESH_TAP];
+    cfg->ofsY        = block[ADXL345_OFSY - ADXL345_THRESH_TAP];
+    cfg->ofsZ        = block[ADXL345_OFSZ - ADXL345_THRESH_TAP];
+    cfg->dur         = block[ADXL345_DUR - ADXL345_THRESH_TAP];
+    cfg->latent      = block[ADXL345_LATENT - ADXL345_THRESH_TAP];
+    cfg->window      = block[ADXL345_WINDOW - ADXL345_THRESH_TAP];
+    cfg->threshAct   = block[ADXL345_THRESH_ACT - ADXL345_THRESH_TAP];
+    cfg->threshInact = block[ADXL345_THRESH_INACT - ADXL345_THRESH_TAP];
+    cfg->timeInact   = block[ADXL345_TIME_INACT - ADXL345_THRESH_TAP];
+    cfg->actInactCtl = block[ADXL345_ACT_INACT_CTL - ADXL345_THRESH_TAP];
+    cfg->threshFF    = block[ADXL345_THRESH_FF - ADXL345_THRESH_TAP];
+    cfg->timeFF      = block[ADXL345_TIME_FF - ADXL345_THRESH_TAP];
+    cfg->tapAxes     = block[ADXL345_TAP_AXES - ADXL345_THRESH_TAP];
+    cfg->bwRate      = block[ADXL345_BW_RATE - ADXL345_THRESH_TAP];
+    cfg->powerCtl    = block[ADXL345_POWER_CTL - ADXL345_THRESH_TAP];
+    cfg->intEnable   = block[ADXL345_INT_ENABLE - ADXL345_THRESH_TAP];
+    cfg->intMap      = block[ADXL345_INT_MAP - ADXL345_THRESH_TAP];
+    return true;
+}
+
 void ADXL345_WE::setSPIClockSpeed(unsigned long clock = 5000000){
-    spiClock = clock;
-    mySPISettings = SPISettings(spiClock, MSBFIRST, SPI_MODE3);
+    spiBus.setClockSpeed(clock);
+}
+
+/* Delay after CS goes low. 0 (default) is sufficient for the datasheet minimum of 5 ns, 
+   increase it for long lines or level shifters. */
+void ADXL345_WE::setSPICSSetupTime(uint8_t us){
+    spiBus.setCSSetupTime(us);
 }
 
 void ADXL345_WE::setCorrFactors(float xMin, float xMax, float yMin, float yMax, float zMin, float zMax){
@@ -83,6 +231,33 @@ void ADXL345_WE::setCorrFactors(float xMin, float xMax, float yMin, float yMax,
     offsetVal.x = (xMax + xMin) * 0.5;
     offsetVal.y = (yMax + yMin) * 0.5;
     offsetVal.z = (zMax + zMin) * 0.5;
+    updateHardwareOffsets();
+}
+
+/* offset and corr as calculated by setCorrFactors(), e.g. from ADXL345_AutoCal. The new values
+   apply to the next conversion, acquisition does not have to be stopped. */
+void ADXL345_WE::setCalibration(const xyzFloat &offset, const xyzFloat &corr){
+    offsetVal = offset;
+    corrFact = corr;
+    updateHardwareOffsets();
+}
+
+void ADXL345_WE::getCalibration(xyzFloat *offset, xyzFloat *corr){
+    *offset = offsetVal;
+    *corr = corrFact;
+}
+
+/* Moves the offsets of setCorrFactors() / setCalibration() into OFSX, OFSY and OFSZ (15.6 mg/LSB),
+   so that the sensor corrects all data including the FIFO. Only the residual of less than 
+   8 mg is subtracted by the library. The registers are updated with each new calibration, but
+   values which are already in the FIFO keep the previous correction. */
+void ADXL345_WE::enableHardwareOffsets(bool enable){
+    hwOffsetEnabled = enable;
+    updateHardwareOffsets();
+}
+
+xyzInt16 ADXL345_WE::getHardwareOffsets(){
+    return xyzInt16(hwOffset[0], hwOffset[1], hwOffset[2]);
 }
 
 bool ADXL345_WE::setDataRate(adxl345_dataRate rate){
@@ -92,6 +267,7 @@ bool ADXL345_WE::setDataRate(adxl345_dataRate rate){
     regVal &= 0xF0;
     regVal |= rate;
     writeRegister(ADXL345_BW_RATE, regVal);
+    resetTimestamps();
     return true;
 }
     
@@ -104,8 +280,17 @@ adxl345_dataRate ADXL345_WE::getDataRate(){
 
 
 String ADXL345_WE::getDataRateAsString(){
-    adxl345_dataRate dataRate = getDataRate();    
-    switch(dataRate) {
+    return String(getDataRateName(getDataRate()));
+}
+
+/* Writes the data rate into buf without heap allocation. Returns the length of the text. */
+size_t ADXL345_WE::getDataRateAsString(char *buf, size_t size){
+    return appendName(buf, size, 0, getDataRateName(getDataRate()));
+}
+
+/* The names are stored in flash. Print them directly or copy them with strcpy_P(). */
+const __FlashStringHelper* ADXL345_WE::getDataRateName(adxl345_dataRate rate){
+    switch(rate) {
         case ADXL345_DATA_RATE_ERROR: return(F("ERROR")); break;
         case ADXL345_DATA_RATE_3200: return(F("3200 Hz")); break;
         case ADXL345_DATA_RATE_1600: return(F("1600 Hz")); break;
@@ -131,18 +316,7 @@ bool ADXL345_WE::setRange(adxl345_range range){
     if (!readRegister8(ADXL345_DATA_FORMAT, &regVal) || range == ADXL345_RANGE_ERROR) {
         return false;
     }
-    if(adxl345_lowRes){
-        switch(range){
-            case ADXL345_RANGE_ERROR: return false; break; // Already handled, but avoids compiler warning
-            case ADXL345_RANGE_2G:  rangeFactor = 1.0;  break;
-            case ADXL345_RANGE_4G:  rangeFactor = 2.0;  break;
-            case ADXL345_RANGE_8G:  rangeFactor = 4.0;  break;
-            case ADXL345_RANGE_16G: rangeFactor = 8.0;  break;  
-        }
-    }
-    else{
-        rangeFactor = 1.0;
-    }
+    updateRangeFactor(range);
     regVal &= 0b11111100;
     regVal |= range;
     writeRegister(ADXL345_DATA_FORMAT, regVal);
@@ -163,22 +337,26 @@ bool ADXL345_WE::setFullRes(bool full){
     }
     if(full){
         adxl345_lowRes = false;
-        rangeFactor = 1.0;
         regVal |= (1<<ADXL345_FULL_RES);
     }
     else{
         adxl345_lowRes = true;
         regVal &= ~(1<<ADXL345_FULL_RES);
-        if (!setRange(getRange())) {
-            return false;
-        }
     }
+    updateRangeFactor(adxl345_range(regVal & 0x03));
     writeRegister(ADXL345_DATA_FORMAT, regVal);
     return true;
 }
 
 String ADXL345_WE::getRangeAsString(){
-    adxl345_range range = getRange();
+    return String(getRangeName(getRange()));
+}
+
+size_t ADXL345_WE::getRangeAsString(char *buf, size_t size){
+    return appendName(buf, size, 0, getRangeName(getRange()));
+}
+
+const __FlashStringHelper* ADXL345_WE::getRangeName(adxl345_range range){
     switch(range){
         case ADXL345_RANGE_ERROR: return(F("ERROR")); break;
         case ADXL345_RANGE_2G:  return(F("2g"));   break;
@@ -186,10 +364,48 @@ String ADXL345_WE::getRangeAsString(){
         case ADXL345_RANGE_8G:  return(F("8g"));   break;
         case ADXL345_RANGE_16G: return(F("16g"));  break;
         default: return(F("unknown"));
-        
     }
 }
 
+/* With the register cache enabled, the writable registers are mirrored in memory. Setters then 
+   only write and getters like getRange() do not access the bus. The cache is filled by init(), 
+   enableRegisterCache() and syncRegisterCache(). */
+bool ADXL345_WE::enableRegisterCache(bool enable){
+    regCacheEnabled = enable;
+    regCacheValid = false;
+    if(enable){
+        return syncRegisterCache();
+    }
+    return true;
+}
+
+bool ADXL345_WE::syncRegisterCache(){
+    regCacheValid = false;
+    if(!regCacheEnabled){
+        return false;
+    }
+    // INT_SOURCE and the data registers are not read since reading them has side effects
+    adxl345_config cfg;
+    if (!getConfig(&cfg)) {
+        return false;
+    }
+    uint8_t block[ADXL345_TAP_AXES - ADXL345_THRESH_TAP + 1] = {
+        cfg.threshTap, cfg.ofsX, cfg.ofsY, cfg.ofsZ, cfg.dur, cfg.latent, cfg.window, cfg.threshAct, 
+        cfg.threshInact, cfg.timeInact, cfg.actInactCtl, cfg.threshFF, cfg.timeFF, cfg.tapAxes
+    };
+    for(uint8_t i=0; i<sizeof(block); i++){
+        cacheStore(ADXL345_THRESH_TAP + i, block[i]);
+    }
+    cacheStore(ADXL345_BW_RATE, cfg.bwRate);
+    cacheStore(ADXL345_POWER_CTL, cfg.powerCtl);
+    cacheStore(ADXL345_INT_ENABLE, cfg.intEnable);
+    cacheStore(ADXL345_INT_MAP, cfg.intMap);
+    cacheStore(ADXL345_DATA_FORMAT, cfg.dataFormat);
+    cacheStore(ADXL345_FIFO_CTL, cfg.fifoCtl);
+    regCacheValid = true;
+    return true;
+}
+
 uint8_t ADXL345_WE::getDeviceID(){
     if (readRegister8(ADXL345_DEVID, &regVal)) {
         return regVal;
@@ -213,9 +429,7 @@ bool ADXL345_WE::getRawValues(xyzFloat *rawVal){
     if (!readMultipleRegisters(ADXL345_DATAX0, 6, rawData)) {
         return false;
     }
-    rawVal->x = (static_cast<int16_t>((rawData[1] << 8) | rawData[0])) * 1.0;
-    rawVal->y = (static_cast<int16_t>((rawData[3] << 8) | rawData[2])) * 1.0;
-    rawVal->z = (static_cast<int16_t>((rawData[5] << 8) | rawData[4])) * 1.0;
+    rawToXyz(rawData, rawVal);
     return true;
 }
 
@@ -223,9 +437,7 @@ bool ADXL345_WE::getCorrectedRawValues(xyzFloat *rawVal){
     if (!getRawValues(rawVal)) {
         return false;
     }
-    rawVal->x -= (offsetVal.x / rangeFactor);
-    rawVal->y -= (offsetVal.y / rangeFactor);
-    rawVal->z -= (offsetVal.z / rangeFactor);
+    *rawVal -= rawOffset;
     return true;
 }
 
@@ -233,48 +445,102 @@ bool ADXL345_WE::getGValues(xyzFloat *gVal){
     if (!getCorrectedRawValues(gVal)) {
         return false;
     }
-    *gVal *= corrFact * MILLI_G_PER_LSB * rangeFactor / 1000.0; 
+    *gVal *= gFactor; 
     return true;
 }
 
-/************ Angles and Orientation ************/ 
-
-bool ADXL345_WE::getAngles(xyzFloat *angleVal){
-    xyzFloat gVal;
-    if (!getGValues(&gVal)) {
+bool ADXL345_WE::getRawValues(xyzInt16 *rawVal){
+    uint8_t rawData[6]; 
+    if (!readMultipleRegisters(ADXL345_DATAX0, 6, rawData)) {
         return false;
     }
-    if(gVal.x > 1){
-        gVal.x = 1;
+    rawToXyz(rawData, rawVal);
+    return true;
+}
+
+/* Integer path without floating point operations, see rawToMilliG() */
+bool ADXL345_WE::getMilliGValues(xyzInt16 *mgVal){
+    if (!getRawValues(mgVal)) {
+        return false;
     }
-    else if(gVal.x < -1){
-        gVal.x = -1;
+    rawToMilliG(*mgVal, mgVal);
+    return true;
+}
+
+/* Converts corrected raw values into milli-g using the fixed point gains and offsets which
+   are precomputed by setCorrFactors(), setRange() and setFullRes(). The result is within 
+   +/-1 mg of 1000 * getGValues() for correction factors below 8. */
+void ADXL345_WE::rawToMilliG(const xyzInt16 &rawVal, xyzInt16 *mgVal){
+    mgVal->x = static_cast<int16_t>((rawVal.x * mgGainQ[0] + mgOffsetQ[0] + (1L<<(MG_Q_BITS-1))) >> MG_Q_BITS);
+    mgVal->y = static_cast<int16_t>((rawVal.y * mgGainQ[1] + mgOffsetQ[1] + (1L<<(MG_Q_BITS-1))) >> MG_Q_BITS);
+    mgVal->z = static_cast<int16_t>((rawVal.z * mgGainQ[2] + mgOffsetQ[2] + (1L<<(MG_Q_BITS-1))) >> MG_Q_BITS);
+}
+
+/************ Block conversions ************/
+
+/* The following functions convert n raw values, e.g. from readFifo(), in one call */
+
+void ADXL345_WE::rawToCorrectedRawValues(const xyzInt16 *rawVal, xyzFloat *corrRawVal, uint16_t n){
+    const xyzFloat offset = rawOffset;
+    for(uint16_t i=0; i<n; i++){
+        corrRawVal[i].x = rawVal[i].x - offset.x;
+        corrRawVal[i].y = rawVal[i].y - offset.y;
+        corrRawVal[i].z = rawVal[i].z - offset.z;
     }
-    angleVal->x = (asin(gVal.x)) * 57.296;
-    
-    if(gVal.y > 1){
-        gVal.y = 1;
+}
+
+void ADXL345_WE::rawToGValues(const xyzInt16 *rawVal, xyzFloat *gVal, uint16_t n){
+    const xyzFloat offset = rawOffset;
+    const xyzFloat factor = gFactor;
+    for(uint16_t i=0; i<n; i++){
+        gVal[i].x = (rawVal[i].x - offset.x) * factor.x;
+        gVal[i].y = (rawVal[i].y - offset.y) * factor.y;
+        gVal[i].z = (rawVal[i].z - offset.z) * factor.z;
     }
-    else if(gVal.y < -1){
-        gVal.y = -1;
+}
+
+/* As above, but with separate arrays for x, y and z. Uses the SIMD kernel of ADXL345_Block.h
+   where available. */
+void ADXL345_WE::rawToGValues(const xyzInt16 *rawVal, float *gX, float *gY, float *gZ, uint16_t n){
+    adxl345_rawToGSoA(rawVal, rawOffset, gFactor, gX, gY, gZ, n);
+}
+
+/* g = (raw - offset) * factor, for the kernels in ADXL345_Block.h. Changes with the range, the 
+   resolution and the calibration. */
+void ADXL345_WE::getScaling(xyzFloat *offset, xyzFloat *factor){
+    *offset = rawOffset;
+    *factor = gFactor;
+}
+
+void ADXL345_WE::rawToMilliG(const xyzInt16 *rawVal, xyzInt16 *mgVal, uint16_t n){
+    for(uint16_t i=0; i<n; i++){
+        rawToMilliG(rawVal[i], &mgVal[i]);
     }
-    angleVal->y = (asin(gVal.y)) * 57.296;
-    
-    if(gVal.z > 1){
-        gVal.z = 1;
+}
+
+void ADXL345_WE::rawToAngles(const xyzInt16 *rawVal, xyzFloat *angleVal, uint16_t n){
+    for(uint16_t i=0; i<n; i++){
+        angleVal[i] = rawToSnapshot(rawVal[i]).getAngles();
     }
-    else if(gVal.z < -1){
-        gVal.z = -1;
+}
+
+/************ Angles and Orientation ************/ 
+
+bool ADXL345_WE::getAngles(xyzFloat *angleVal){
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
+        return false;
     }
-    angleVal->z = (asin(gVal.z)) * 57.296;
+    *angleVal = snap.getAngles();
     return true;
 }
 
 bool ADXL345_WE::getCorrAngles(xyzFloat *corrAngleVal){
-    if (!getAngles(corrAngleVal)) {
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
         return false;
     }
-    *corrAngleVal -= angleOffsetVal;
+    *corrAngleVal = snap.getCorrAngles();
     return true;
 }
 
@@ -291,71 +557,81 @@ void ADXL345_WE::setAngleOffsets(const xyzFloat aos){
 }
 
 adxl345_orientation ADXL345_WE::getOrientation(){
-    adxl345_orientation orientation = FLAT;
-    xyzFloat angleVal;
-    if (!getAngles(&angleVal)) {
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
         return ADXL345_ORIENTATION_ERROR;
     }
-    if(abs(angleVal.x) < 45){      // |x| < 45
-        if(abs(angleVal.y) < 45){      // |y| < 45
-            if(angleVal.z > 0){          //  z  > 0
-                orientation = FLAT;
-            }
-            else{                        //  z  < 0
-                orientation = FLAT_1;
-            }
-        }
-        else{                         // |y| > 45 
-            if(angleVal.y > 0){         //  y  > 0
-                orientation = XY;
-            }
-            else{                       //  y  < 0
-                orientation = XY_1;   
-            }
-        }
-    }
-    else{                           // |x| >= 45
-        if(angleVal.x > 0){           //  x  >  0
-            orientation = YX;       
-        }
-        else{                       //  x  <  0
-            orientation = YX_1;
-        }
-    }
-    return orientation;
+    return snap.getOrientation();
 }
 
 String ADXL345_WE::getOrientationAsString(){
-    adxl345_orientation orientation = getOrientation();
-    String orientationAsString = "";
+    return String(getOrientationName(getOrientation()));
+}
+
+size_t ADXL345_WE::getOrientationAsString(char *buf, size_t size){
+    return appendName(buf, size, 0, getOrientationName(getOrientation()));
+}
+
+const __FlashStringHelper* ADXL345_WE::getOrientationName(adxl345_orientation orientation){
     switch(orientation){
-        case ADXL345_ORIENTATION_ERROR: orientationAsString = "ERROR"; break;
-        case FLAT:      orientationAsString = "z up";   break;
-        case FLAT_1:    orientationAsString = "z down"; break;
-        case XY:        orientationAsString = "y up";   break;
-        case XY_1:      orientationAsString = "y down"; break;
-        case YX:        orientationAsString = "x up";   break;
-        case YX_1:      orientationAsString = "x down"; break;
-    }
-    return orientationAsString;
+        case ADXL345_ORIENTATION_ERROR: return(F("ERROR")); break;
+        case FLAT:      return(F("z up"));   break;
+        case FLAT_1:    return(F("z down")); break;
+        case XY:        return(F("y up"));   break;
+        case XY_1:      return(F("y down")); break;
+        case YX:        return(F("x up"));   break;
+        case YX_1:      return(F("x down")); break;
+    }
+    return(F("unknown"));
 }
 
 float ADXL345_WE::getPitch(){
-    xyzFloat gVal;
-    if (!getGValues(&gVal)) {
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
         return ADXL345_FLOAT_ERROR;
     }
-    float pitch = (atan2(-gVal.x, sqrt(abs((gVal.y*gVal.y + gVal.z*gVal.z))))*180.0)/M_PI;
-    return pitch;
+    return snap.getPitch();
 }
     
 float ADXL345_WE::getRoll(){
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
+        return ADXL345_FLOAT_ERROR;
+    }
+    return snap.getRoll();
+}
+
+bool ADXL345_WE::getPitchRoll(float *pitch, float *roll){
+    ADXL345_Snapshot snap;
+    if (!getSnapshot(&snap)) {
+        *pitch = ADXL345_FLOAT_ERROR;
+        *roll = ADXL345_FLOAT_ERROR;
+        return false;
+    }
+    snap.getPitchRoll(pitch, roll);
+    return true;
+}
+
+/* Selects the kernels for angles, pitch and roll, see ADXL345_FastMath.h */
+void ADXL345_WE::setTrigMode(adxl345_trigMode mode){
+    trigMode = mode;
+}
+
+/* One read of the current g values, from which all derived quantities can be calculated */
+bool ADXL345_WE::getSnapshot(ADXL345_Snapshot *snap){
     xyzFloat gVal;
     if (!getGValues(&gVal)) {
-        return ADXL345_FLOAT_ERROR;
+        return false;
     }
-    float roll = (atan2(gVal.y, gVal.z)*180.0)/M_PI;
-    return roll;
+    *snap = ADXL345_Snapshot(gVal, angleOffsetVal, trigMode);
+    return true;
+}
+
+/* Snapshot of a raw value, e.g. from readFifo() */
+ADXL345_Snapshot ADXL345_WE::rawToSnapshot(const xyzInt16 &rawVal){
+    const xyzFloat gVal((rawVal.x - rawOffset.x) * gFactor.x, (rawVal.y - rawOffset.y) * gFactor.y,
+                        (rawVal.z - rawOffset.z) * gFactor.z);
+    return ADXL345_Snapshot(gVal, angleOffsetVal, trigMode);
 }
 
 /************ Power, Sleep, Standby ************/ 
@@ -496,6 +772,11 @@ uint8_t ADXL345_WE::readAndClearInterrupts(){
     if (!readRegister8(ADXL345_INT_SOURCE, &regVal)) {
         return 0; // Not ideal
     }
+#ifdef ADXL345_ENABLE_STATS
+    if(checkInterrupt(regVal, ADXL345_OVERRUN)){
+        stats.fifoOverruns++;
+    }
+#endif
     return regVal;
 }
 
@@ -617,18 +898,29 @@ uint8_t ADXL345_WE::getActTapStatus(){
 }
 
 String ADXL345_WE::getActTapStatusAsString(){
+    char buf[ADXL345_ACT_TAP_STR_SIZE];
+    getActTapStatusAsString(buf, sizeof(buf));
+    return String(buf);
+}
+
+size_t ADXL345_WE::getActTapStatusAsString(char *buf, size_t size){
     if (!readRegister8(ADXL345_ACT_TAP_STATUS, &regVal)) {
-        return String("ERROR");
-    }
-    String returnStr = "";
-    if(regVal & (1<<ADXL345_TAP_Z)) { returnStr += "TAP-Z "; }
-    if(regVal & (1<<ADXL345_TAP_Y)) { returnStr += "TAP-Y "; }
-    if(regVal & (1<<ADXL345_TAP_X)) { returnStr += "TAP-X "; }
-    if(regVal & (1<<ADXL345_ACT_Z)) { returnStr += "ACT-Z "; }
-    if(regVal & (1<<ADXL345_ACT_Y)) { returnStr += "ACT-Y "; }
-    if(regVal & (1<<ADXL345_ACT_X)) { returnStr += "ACT-X "; }
-    
-    return returnStr;
+        return appendName(buf, size, 0, F("ERROR"));
+    }
+    return actTapStatusToString(regVal, buf, size);
+}
+
+/* Formats a value from getActTapStatus() without reading the register again. A buffer of 
+   ADXL345_ACT_TAP_STR_SIZE bytes is always sufficient. */
+size_t ADXL345_WE::actTapStatusToString(uint8_t status, char *buf, size_t size){
+    size_t len = appendName(buf, size, 0, F(""));
+    if(status & (1<<ADXL345_TAP_Z)) { len = appendName(buf, size, len, F("TAP-Z ")); }
+    if(status & (1<<ADXL345_TAP_Y)) { len = appendName(buf, size, len, F("TAP-Y ")); }
+    if(status & (1<<ADXL345_TAP_X)) { len = appendName(buf, size, len, F("TAP-X ")); }
+    if(status & (1<<ADXL345_ACT_Z)) { len = appendName(buf, size, len, F("ACT-Z ")); }
+    if(status & (1<<ADXL345_ACT_Y)) { len = appendName(buf, size, len, F("ACT-Y ")); }
+    if(status & (1<<ADXL345_ACT_X)) { len = appendName(buf, size, len, F("ACT-X ")); }
+    return len;
 }
 
 /************ FIFO ************/
@@ -667,88 +959,284 @@ bool ADXL345_WE::resetTrigger(){
     return setFifoMode(ADXL345_BYPASS) && setFifoMode(ADXL345_TRIGGER);
 }
 
+/* Reads all entries available in FIFO_STATUS (max. maxSamples) as raw values into rawBuf.
+   All entries are fetched with one call of the bus' readFifoEntries(), which holds the bus 
+   (SPI) for the whole drain. The raw bytes are parked in the upper half of rawBuf and 
+   converted in place from front to back. Returns the number of samples delivered. */
+uint8_t ADXL345_WE::readFifo(xyzFloat *rawBuf, uint8_t maxSamples){
+    if (!readRegister8(ADXL345_FIFO_STATUS, &regVal)) {
+        return 0;
+    }
+    uint8_t entries = regVal & ADXL345_FIFO_ENTRIES;
+    if(entries > maxSamples){
+        entries = maxSamples;
+    }
+    uint8_t *rawData = reinterpret_cast<uint8_t*>(rawBuf) + entries * (sizeof(xyzFloat) - 6);
+    uint32_t start = statsStart();
+    uint8_t delivered = activeBus()->readFifoEntries(rawData, entries);
+    statsBus(start, entries, entries * (ADXL345_Bus::ADXL345_FIFO_ENTRY_SIZE + 1), delivered == entries);
+    statsDrained(delivered);
+    for(int i=0; i<delivered; i++){
+        rawToXyz(rawData + 6*i, &rawBuf[i]);
+    }
+    return delivered;
+}
+
+
+/* As above, but the raw bytes are read directly into rawBuf (6 bytes per entry, like xyzInt16)
+   and converted in place. */
+uint8_t ADXL345_WE::readFifo(xyzInt16 *rawBuf, uint8_t maxSamples){
+    if (!readRegister8(ADXL345_FIFO_STATUS, &regVal)) {
+        return 0;
+    }
+    uint8_t entries = regVal & ADXL345_FIFO_ENTRIES;
+    if(entries > maxSamples){
+        entries = maxSamples;
+    }
+    return drainFifo(rawBuf, entries);
+}
+
+/* Reads a known number of entries, e.g. taken from a previous getFifoStatus(), without
+   reading FIFO_STATUS again. Never request more entries than the FIFO holds. */
+uint8_t ADXL345_WE::drainFifo(xyzInt16 *rawBuf, uint8_t entries){
+    uint8_t *rawData = reinterpret_cast<uint8_t*>(rawBuf);
+    uint32_t start = statsStart();
+    uint8_t delivered = activeBus()->readFifoEntries(rawData, entries);
+    statsBus(start, entries, entries * (ADXL345_Bus::ADXL345_FIFO_ENTRY_SIZE + 1), delivered == entries);
+    statsDrained(delivered);
+    adxl345_bytesToRaw(rawData, rawBuf, delivered);
+    return delivered;
+}
+
+/* As above, with a reconstructed time stamp (micros()) for each entry, see ADXL345_Timebase.h. 
+   The time base starts with the nominal data rate and tracks the true rate from then on. */
+uint8_t ADXL345_WE::readFifo(xyzInt16 *rawBuf, uint32_t *timestamps, uint8_t maxSamples){
+    if(!timebase.isStarted()){
+        timebase.reset(dataRateToHz(getDataRate()));
+    }
+    if (!readRegister8(ADXL345_FIFO_STATUS, &regVal)) {
+        return 0;
+    }
+    uint32_t drainMicros = micros();
+    uint8_t entries = regVal & ADXL345_FIFO_ENTRIES;
+    uint8_t delivered = drainFifo(rawBuf, (entries > maxSamples) ? maxSamples : entries);
+    timebase.stamp(drainMicros, entries, delivered, timestamps);
+    return delivered;
+}
+
+float ADXL345_WE::getMeasuredDataRate(){
+    return timebase.getDataRateHz();
+}
+
+/* Deviation of the measured from the nominal data rate in ppm */
+float ADXL345_WE::getDataRateDriftPpm(){
+    return timebase.getDriftPpm();
+}
+
+/* The time base restarts with the next readFifo() with time stamps. Called automatically
+   when the data rate changes. */
+void ADXL345_WE::resetTimestamps(){
+    timebase.reset(0.0);
+}
+
+/* Returns nullptr if ADXL345_ENABLE_STATS is not defined */
+const ADXL345_Stats* ADXL345_WE::getStats(){
+#ifdef ADXL345_ENABLE_STATS
+    return &stats;
+#else
+    return nullptr;
+#endif
+}
+
+void ADXL345_WE::resetStats(){
+#ifdef ADXL345_ENABLE_STATS
+    stats.reset();
+    watermarkPending = false;
+#endif
+}
+
+/* Call this in the watermark ISR. The next FIFO drain records the latency. */
+void ADXL345_WE::markWatermark(){
+#ifdef ADXL345_ENABLE_STATS
+    if(!watermarkPending){
+        watermarkMicros = micros();
+        watermarkPending = true;
+    }
+#endif
+}
+
+float ADXL345_WE::dataRateToHz(adxl345_dataRate rate){
+    if(rate == ADXL345_DATA_RATE_ERROR){
+        return 0.0;
+    }
+    return 3200.0 / static_cast<float>(1UL << (ADXL345_DATA_RATE_3200 - rate));
+}
+
 
 /************************************************ 
     private functions
 *************************************************/
 
-void ADXL345_WE::writeRegister(uint8_t reg, uint8_t val){
-    if(!useSPI){
-        _wire->beginTransmission(i2cAddress);
-        _wire->write(reg);
-        _wire->write(val);
-        _wire->endTransmission();    
+/* Copies a name from flash to buf[pos], truncated to size, always terminated. Returns the new 
+   length. */
+size_t ADXL345_WE::appendName(char *buf, size_t size, size_t pos, const __FlashStringHelper *name){
+    if(size == 0){
+        return 0;
     }
-    else{
-        _spi->beginTransaction(mySPISettings);
-        digitalWrite(csPin, LOW);
-        delayMicroseconds(5);
-        _spi->transfer(reg); 
-        _spi->transfer(val);
-        digitalWrite(csPin, HIGH);
-        _spi->endTransaction();
+    const char *p = reinterpret_cast<const char*>(name);
+    char c;
+    while(pos + 1 < size && (c = pgm_read_byte(p++)) != '\0'){
+        buf[pos++] = c;
     }
+    buf[pos] = '\0';
+    return pos;
 }
-  
-bool ADXL345_WE::readRegister8(uint8_t reg, uint8_t *val){
-    if(!useSPI){    
-        bool ok = true;
-        _wire->beginTransmission(i2cAddress);
-        ok &= (_wire->write(reg) == 1);
-        ok &= (_wire->endTransmission(false) == 0);
-        _wire->requestFrom(i2cAddress, static_cast<uint8_t>(1));
-        if(ok && _wire->available()){
-            // Success
-            *val = _wire->read();
-            return true;
-        } 
-        // No response
-        return false;
+
+void ADXL345_WE::updateRangeFactor(adxl345_range range){
+    if(adxl345_lowRes){
+        switch(range){
+            case ADXL345_RANGE_ERROR: break; // Not possible, but avoids compiler warning
+            case ADXL345_RANGE_2G:  rangeFactor = 1.0;  break;
+            case ADXL345_RANGE_4G:  rangeFactor = 2.0;  break;
+            case ADXL345_RANGE_8G:  rangeFactor = 4.0;  break;
+            case ADXL345_RANGE_16G: rangeFactor = 8.0;  break;  
+        }
     }
     else{
-        reg |= 0x80;
-        _spi->beginTransaction(mySPISettings);
-        digitalWrite(csPin, LOW);
-        delayMicroseconds(5);
-        _spi->transfer(reg); 
-        *val = _spi->transfer(0x00);
-        digitalWrite(csPin, HIGH);
-        _spi->endTransaction();
-        return true; // Error checking is not possible with SPI
+        rangeFactor = 1.0;
     }
+    updateScaling();
 }
 
-bool ADXL345_WE::readMultipleRegisters(uint8_t reg, uint8_t count, uint8_t *buf){
-    if(!useSPI){
-        bool ok = true;
-        _wire->beginTransmission(i2cAddress);
-        ok &= (_wire->write(reg) == 1);
-        ok &= (_wire->endTransmission(false) == 0);
-        _wire->requestFrom(i2cAddress, count);
-        if (ok && _wire->available() == count) {
-            // Success
-            for(int i=0; i<count; i++){
-                buf[i] = _wire->read();
-            }
-            return true;
+/* Precomputes the float and fixed point factors of the conversion raw -> g. They only change 
+   with the correction factors, the range and the resolution. */
+void ADXL345_WE::updateScaling(){
+    const float unitsPerOfsLsb = MILLI_G_PER_OFS_LSB / MILLI_G_PER_LSB;
+    const xyzFloat hwCorrected(-hwOffset[0] * unitsPerOfsLsb, -hwOffset[1] * unitsPerOfsLsb, 
+                               -hwOffset[2] * unitsPerOfsLsb);
+    rawOffset = (offsetVal - hwCorrected) / rangeFactor;
+    gFactor = corrFact * MILLI_G_PER_LSB * rangeFactor / 1000.0;
+    const float corr[3] = {corrFact.x, corrFact.y, corrFact.z};
+    const float offset[3] = {rawOffset.x, rawOffset.y, rawOffset.z};
+    for(int i=0; i<3; i++){
+        float mgPerLsb = corr[i] * MILLI_G_PER_LSB * rangeFactor;
+        mgGainQ[i] = lround(mgPerLsb * (1L<<MG_Q_BITS));
+        mgOffsetQ[i] = lround(-offset[i] * mgPerLsb * (1L<<MG_Q_BITS));
+    }
+}
+
+/* The OFSX-Z values are independent of range and resolution, the residual is scaled by 
+   updateScaling(). Registers are only written if a value changes. */
+void ADXL345_WE::updateHardwareOffsets(){
+    const float unitsPerOfsLsb = MILLI_G_PER_OFS_LSB / MILLI_G_PER_LSB;
+    const float offset[3] = {offsetVal.x, offsetVal.y, offsetVal.z};
+    int8_t ofs[3] = {0, 0, 0};
+    bool changed = false;
+    for(int i=0; i<3; i++){
+        if(hwOffsetEnabled){
+            long val = -lround(offset[i] / unitsPerOfsLsb);
+            ofs[i] = static_cast<int8_t>((val > 127) ? 127 : ((val < -128) ? -128 : val));
         }
-        // No response, or incomplete response
-        return false;
+        changed |= (ofs[i] != hwOffset[i]);
     }
-    else{
-        reg = reg | 0x80;
-        reg = reg | 0x40;
-        _spi->beginTransaction(mySPISettings);
-        digitalWrite(csPin, LOW);
-        delayMicroseconds(5);
-        _spi->transfer(reg); 
-        for(int i=0; i<count; i++){
-            buf[i] = _spi->transfer(0x00);
+    if(changed){
+        uint8_t regs[3] = {static_cast<uint8_t>(ofs[0]), static_cast<uint8_t>(ofs[1]), static_cast<uint8_t>(ofs[2])};
+        writeMultipleRegisters(ADXL345_OFSX, 3, regs);
+        for(int i=0; i<3; i++){
+            hwOffset[i] = ofs[i];
         }
-        digitalWrite(csPin, HIGH);
-        _spi->endTransaction();
-        return true; // Error checking is not possible with SPI
     }
+    updateScaling();
+}
+
+bool ADXL345_WE::isCacheable(uint8_t reg){
+    if(reg >= ADXL345_THRESH_TAP && reg <= ADXL345_INT_MAP){
+        return reg != ADXL345_ACT_TAP_STATUS;
+    }
+    return reg == ADXL345_DATA_FORMAT || reg == ADXL345_FIFO_CTL;
+}
+
+void ADXL345_WE::cacheStore(uint8_t reg, uint8_t val){
+    if(isCacheable(reg)){
+        regCache[reg - ADXL345_THRESH_TAP] = val;
+    }
+}
+
+/* rawData may overlap rawVal (see readFifo), so all bytes are read before rawVal is written */
+void ADXL345_WE::rawToXyz(const uint8_t *rawData, xyzFloat *rawVal){
+    int16_t x = static_cast<int16_t>((rawData[1] << 8) | rawData[0]);
+    int16_t y = static_cast<int16_t>((rawData[3] << 8) | rawData[2]);
+    int16_t z = static_cast<int16_t>((rawData[5] << 8) | rawData[4]);
+    rawVal->x = x * 1.0;
+    rawVal->y = y * 1.0;
+    rawVal->z = z * 1.0;
+}
+
+void ADXL345_WE::rawToXyz(const uint8_t *rawData, xyzInt16 *rawVal){
+    int16_t x = static_cast<int16_t>((rawData[1] << 8) | rawData[0]);
+    int16_t y = static_cast<int16_t>((rawData[3] << 8) | rawData[2]);
+    int16_t z = static_cast<int16_t>((rawData[5] << 8) | rawData[4]);
+    rawVal->x = x;
+    rawVal->y = y;
+    rawVal->z = z;
+}
+
+void ADXL345_WE::writeRegister(uint8_t reg, uint8_t val){
+    uint32_t start = statsStart();
+    bool ok = activeBus()->writeRegisters(reg, &val, 1);
+    statsBus(start, 1, 2, ok);
+    cacheStore(reg, val);
+}
+  
+bool ADXL345_WE::readRegister8(uint8_t reg, uint8_t *val){
+    if(regCacheValid && isCacheable(reg)){
+        *val = regCache[reg - ADXL345_THRESH_TAP];
+        return true;
+    }
+    uint32_t start = statsStart();
+    bool ok = activeBus()->readRegisters(reg, val, 1);
+    statsBus(start, 1, 2, ok);
+    return ok;
 }
 
+void ADXL345_WE::writeMultipleRegisters(uint8_t reg, uint8_t count, const uint8_t *buf){
+    uint32_t start = statsStart();
+    bool ok = activeBus()->writeRegisters(reg, buf, count);
+    statsBus(start, 1, count + 1, ok);
+    for(int i=0; i<count; i++){
+        cacheStore(reg + i, buf[i]);
+    }
+}
 
+bool ADXL345_WE::readMultipleRegisters(uint8_t reg, uint8_t count, uint8_t *buf){
+    uint32_t start = statsStart();
+    bool ok = activeBus()->readRegisters(reg, buf, count);
+    statsBus(start, 1, count + 1, ok);
+    return ok;
+}
+
+/* A FIFO drain with n entries counts as n transactions, but only once in the histogram */
+void ADXL345_WE::statsBus(uint32_t start, uint8_t transactions, uint16_t bytes, bool ok){
+#ifdef ADXL345_ENABLE_STATS
+    stats.transactionMicros.add(micros() - start);
+    stats.transactions += transactions;
+    stats.bytes += bytes;
+    if(!ok){
+        stats.busErrors++;
+    }
+#else
+    (void)start; (void)transactions; (void)bytes; (void)ok;
+#endif
+}
+
+void ADXL345_WE::statsDrained(uint8_t samples){
+#ifdef ADXL345_ENABLE_STATS
+    stats.samplesDrained += samples;
+    if(watermarkPending){
+        stats.watermarkLatencyMicros.add(micros() - watermarkMicros);
+        watermarkPending = false;
+    }
+#else
+    (void)samples;
+#endif
+}
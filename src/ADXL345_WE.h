@@ -19,15 +19,26 @@
 #ifndef ADXL345_WE_H_
 #define ADXL345_WE_H_
 
-#if (ARDUINO >= 100)
+#if defined(ARDUINO) && (ARDUINO >= 100)
  #include "Arduino.h"
-#else
+ #include <Wire.h>
+ #include <SPI.h>
+#elif defined(ARDUINO)
  #include "WProgram.h"
+ #include <Wire.h>
+ #include <SPI.h>
+#else
+ #include "ADXL345_host.h"
 #endif
 
-#include <Wire.h>
-#include <SPI.h>
+#include "ADXL345_Options.h"
+#include "ADXL345_Bus.h"
+#include "ADXL345_Stats.h"
+#include "ADXL345_FastMath.h"
+#include "ADXL345_Block.h"
+#include "ADXL345_Timebase.h"
 #include "xyzFloat.h"
+#include "xyzInt16.h"
 
 /* Definitions */
 
@@ -176,21 +187,74 @@ typedef enum ADXL345_TRIGGER_INT {
     ADXL343_TRIGGER_INT_2 = ADXL345_TRIGGER_INT_2
 } adxl345_triggerInt;
 
+/* Consistent set of g values from one read (getSnapshot()) or one FIFO entry (rawToSnapshot()).
+   Angles, pitch, roll and orientation are calculated from it without accessing the bus. */
+class ADXL345_Snapshot
+{
+    public:
+        ADXL345_Snapshot() {}
+        ADXL345_Snapshot(const xyzFloat &g, const xyzFloat &angleOffsets = xyzFloat(), 
+                         adxl345_trigMode mode = ADXL345_TRIG_LIBM) 
+            : gVal{g}, angleOffsetVal{angleOffsets}, trigMode{mode} {}
+
+        xyzFloat getGValues() const { return gVal; }
+        xyzFloat getAngles() const;
+        xyzFloat getCorrAngles() const;
+        adxl345_orientation getOrientation() const;
+        float getPitch() const;
+        float getRoll() const;
+        void getPitchRoll(float *pitch, float *roll) const;
+
+    protected:
+        xyzFloat gVal;
+        xyzFloat angleOffsetVal;
+        adxl345_trigMode trigMode = ADXL345_TRIG_LIBM;
+        static float asinDeg(float val, adxl345_trigMode mode);
+};
+
+/* Raw register values of all writable registers, see data sheet for the units. The defaults 
+   are the settings init() applies. */
+typedef struct ADXL345_CONFIG {
+    uint8_t threshTap   = 0;    // THRESH_TAP, 62.5 mg/LSB
+    uint8_t ofsX        = 0;    // OFSX, 15.6 mg/LSB
+    uint8_t ofsY        = 0;    // OFSY, 15.6 mg/LSB
+    uint8_t ofsZ        = 0;    // OFSZ, 15.6 mg/LSB
+    uint8_t dur         = 0;    // DUR, 625 µs/LSB
+    uint8_t latent      = 0;    // LATENT, 1.25 ms/LSB
+    uint8_t window      = 0;    // WINDOW, 1.25 ms/LSB
+    uint8_t threshAct   = 0;    // THRESH_ACT, 62.5 mg/LSB
+    uint8_t threshInact = 0;    // THRESH_INACT, 62.5 mg/LSB
+    uint8_t timeInact   = 0;    // TIME_INACT, 1 s/LSB
+    uint8_t actInactCtl = 0;    // ACT_INACT_CTL
+    uint8_t threshFF    = 0;    // THRESH_FF, 62.5 mg/LSB
+    uint8_t timeFF      = 0;    // TIME_FF, 5 ms/LSB
+    uint8_t tapAxes     = 0;    // TAP_AXES
+    uint8_t bwRate      = ADXL345_DATA_RATE_100;                         // BW_RATE
+    uint8_t powerCtl    = (1<<ADXL345_AUTO_SLEEP) | (1<<ADXL345_MEASURE); // POWER_CTL
+    uint8_t intEnable   = 0;    // INT_ENABLE
+    uint8_t intMap      = 0;    // INT_MAP
+    uint8_t dataFormat  = 0x08; // DATA_FORMAT, full resolution, 2g
+    uint8_t fifoCtl     = 0;    // FIFO_CTL, bypass
+} adxl345_config;
+
 class ADXL345_WE
 {
     public: 
         
         /* Constructors */
         
-        ADXL345_WE(uint8_t addr = 0x53) : _wire{&Wire}, i2cAddress{addr}, useSPI{false} {}
+        ADXL345_WE(uint8_t addr = 0x53) : i2cBus{&Wire, addr}, useSPI{false} {}
         
-        ADXL345_WE(TwoWire *w, uint8_t addr = 0x53) : _wire{w}, i2cAddress{addr}, useSPI{false} {}
+        ADXL345_WE(TwoWire *w, uint8_t addr = 0x53) : i2cBus{w, addr}, useSPI{false} {}
         
         ADXL345_WE(int cs, bool spi, int mosi = 999, int miso = 999, int sck = 999, int sid = -1) 
-            : _spi{&SPI}, csPin{cs}, useSPI{spi}, mosiPin{mosi}, misoPin{miso}, sckPin{sck}, sensorID{sid} {}
+            : spiBus{&SPI, cs, mosi, miso, sck}, useSPI{spi}, sensorID{sid} {}
             
         ADXL345_WE(SPIClass *s, int cs, bool spi, int mosi = 999, int miso = 999, int sck = 999, int sid = -1)
-            :  _spi{s}, csPin{cs}, useSPI{spi}, mosiPin{mosi}, misoPin{miso}, sckPin{sck}, sensorID{sid} {}
+            : spiBus{s, cs, mosi, miso, sck}, useSPI{spi}, sensorID{sid} {}
+        
+        /* Any other transport, e.g. ADXL345_SimBus (software model of the ADXL345) */
+        ADXL345_WE(ADXL345_Bus *b) : extBus{b}, useSPI{false} {}
         
         /* registers */
         
@@ -231,25 +295,43 @@ class ADXL345_WE
         static constexpr uint8_t ADXL345_SUPPRESS         {0x03};
         static constexpr uint8_t ADXL345_LOW_POWER        {0x04};
         static constexpr uint8_t ADXL345_DEVICE_ID_VAL    {0xE5};
+        static constexpr uint8_t ADXL345_FIFO_ENTRIES     {0x3F}; // entries bits in FIFO_STATUS
+        static constexpr uint8_t ADXL345_ACT_TAP_STR_SIZE {37};   // "TAP-Z TAP-Y TAP-X ACT-Z ACT-Y ACT-X "
         
         /* Other */
         
         static constexpr float MILLI_G_PER_LSB             {3.9};
         static constexpr float UNITS_PER_G              {256.41};// = 1/0.0039
+        static constexpr float MILLI_G_PER_OFS_LSB      {15.6};  // OFSX, OFSY, OFSZ
+        static constexpr uint8_t MG_Q_BITS               {13};    // fractional bits of the fixed point gains
     
         /* Basic settings */
         
         bool init();
+        void applyConfig(const adxl345_config &cfg);
+        bool getConfig(adxl345_config *cfg);
         void setSPIClockSpeed(unsigned long clock);
+        void setSPICSSetupTime(uint8_t us);
         void setCorrFactors(float xMin, float xMax, float yMin, float yMax, float zMin, float zMax);
+        void setCalibration(const xyzFloat &offset, const xyzFloat &corr);
+        void getCalibration(xyzFloat *offset, xyzFloat *corr);
+        float getRangeFactor() { return rangeFactor; }
+        void enableHardwareOffsets(bool enable = true);
+        xyzInt16 getHardwareOffsets();
         bool setDataRate(adxl345_dataRate rate);
         adxl345_dataRate getDataRate();
         String getDataRateAsString();
+        size_t getDataRateAsString(char *buf, size_t size);
+        static const __FlashStringHelper* getDataRateName(adxl345_dataRate rate);
         uint8_t getPowerCtlReg();
         bool setRange(adxl345_range range);
         adxl345_range getRange();
         bool setFullRes(bool full);
         String getRangeAsString();
+        size_t getRangeAsString(char *buf, size_t size);
+        static const __FlashStringHelper* getRangeName(adxl345_range range);
+        bool enableRegisterCache(bool enable = true);
+        bool syncRegisterCache();
         uint8_t getDeviceID();
         bool isConnected();
         
@@ -258,6 +340,18 @@ class ADXL345_WE
         bool getRawValues(xyzFloat *rawVal);
         bool getCorrectedRawValues(xyzFloat *rawVal);
         bool getGValues(xyzFloat *gVal);
+        bool getRawValues(xyzInt16 *rawVal);
+        bool getMilliGValues(xyzInt16 *mgVal);
+        void rawToMilliG(const xyzInt16 &rawVal, xyzInt16 *mgVal);
+        
+        /* Block conversions of raw values */
+        
+        void rawToCorrectedRawValues(const xyzInt16 *rawVal, xyzFloat *corrRawVal, uint16_t n);
+        void rawToGValues(const xyzInt16 *rawVal, xyzFloat *gVal, uint16_t n);
+        void rawToGValues(const xyzInt16 *rawVal, float *gX, float *gY, float *gZ, uint16_t n);
+        void getScaling(xyzFloat *offset, xyzFloat *factor);
+        void rawToMilliG(const xyzInt16 *rawVal, xyzInt16 *mgVal, uint16_t n);
+        void rawToAngles(const xyzInt16 *rawVal, xyzFloat *angleVal, uint16_t n);
             
         /* Angles and Orientation */ 
         
@@ -268,8 +362,14 @@ class ADXL345_WE
         void setAngleOffsets(const xyzFloat aos);
         adxl345_orientation getOrientation();
         String getOrientationAsString();
+        size_t getOrientationAsString(char *buf, size_t size);
+        static const __FlashStringHelper* getOrientationName(adxl345_orientation orientation);
         float getPitch();
         float getRoll();
+        bool getPitchRoll(float *pitch, float *roll);
+        void setTrigMode(adxl345_trigMode mode);
+        bool getSnapshot(ADXL345_Snapshot *snap);
+        ADXL345_Snapshot rawToSnapshot(const xyzInt16 &rawVal);
         
         /* Power, Sleep, Standby */ 
         
@@ -295,6 +395,8 @@ class ADXL345_WE
         bool setAdditionalDoubleTapParameters(bool suppress, float window);
         uint8_t getActTapStatus();
         String getActTapStatusAsString();
+        size_t getActTapStatusAsString(char *buf, size_t size);
+        static size_t actTapStatusToString(uint8_t status, char *buf, size_t size);
         
         /* FIFO */
         
@@ -302,27 +404,76 @@ class ADXL345_WE
         bool setFifoMode(adxl345_fifoMode mode);
         uint8_t getFifoStatus();
         bool resetTrigger();
+        uint8_t readFifo(xyzFloat *rawBuf, uint8_t maxSamples);
+        uint8_t readFifo(xyzInt16 *rawBuf, uint8_t maxSamples);
+        uint8_t drainFifo(xyzInt16 *rawBuf, uint8_t entries);
+        uint8_t readFifo(xyzInt16 *rawBuf, uint32_t *timestamps, uint8_t maxSamples);
+        float getMeasuredDataRate();
+        float getDataRateDriftPpm();
+        void resetTimestamps();
+
+        /* Instrumentation, see ADXL345_Stats.h */
+        const ADXL345_Stats* getStats();
+        void resetStats();
+        void markWatermark();
+        static float dataRateToHz(adxl345_dataRate rate);
        
     protected:
-        TwoWire *_wire;
-        SPIClass *_spi;
-        SPISettings mySPISettings = SPISettings();
-        unsigned long spiClock = 5000000;
-        uint8_t i2cAddress;
+        friend class ADXL345_Async;
+        friend class ADXL345_Dispatcher;
+        ADXL345_I2CBus i2cBus;
+        ADXL345_SPIBus spiBus;
+        ADXL345_Bus *extBus = nullptr;
         uint8_t regVal;   // intermediate storage of register values
         xyzFloat offsetVal;
         xyzFloat angleOffsetVal;
         xyzFloat corrFact;
-        int csPin;
         bool useSPI;    
-        int mosiPin;
-        int misoPin;
-        int sckPin;  
         int sensorID;
         float rangeFactor;
+        adxl345_trigMode trigMode = ADXL345_TRIG_LIBM;
+        ADXL345_Timebase timebase;
+#ifdef ADXL345_ENABLE_STATS
+        ADXL345_Stats stats;
+        volatile uint32_t watermarkMicros = 0;
+        volatile bool watermarkPending = false;
+#endif
+        bool hwOffsetEnabled = false;
+        int8_t hwOffset[3] = {0, 0, 0};   // OFSX, OFSY, OFSZ as written by updateHardwareOffsets()
+        xyzFloat rawOffset;     // (offsetVal - part corrected by OFSX-Z) / rangeFactor
+        xyzFloat gFactor;       // corrFact * MILLI_G_PER_LSB * rangeFactor / 1000
+        int32_t mgGainQ[3];     // mg per LSB, fixed point with MG_Q_BITS fractional bits
+        int32_t mgOffsetQ[3];   // offset in mg, fixed point with MG_Q_BITS fractional bits
+        bool regCacheEnabled = false;
+        bool regCacheValid = false;
+        uint8_t regCache[ADXL345_FIFO_CTL - ADXL345_THRESH_TAP + 1]; // shadow of writable registers
+        ADXL345_Bus* activeBus(){
+            if(extBus){
+                return extBus;
+            }
+            return useSPI ? static_cast<ADXL345_Bus*>(&spiBus) : static_cast<ADXL345_Bus*>(&i2cBus);
+        }
+        uint32_t statsStart(){
+#ifdef ADXL345_ENABLE_STATS
+            return micros();
+#else
+            return 0;
+#endif
+        }
+        void statsBus(uint32_t start, uint8_t transactions, uint16_t bytes, bool ok);
+        void statsDrained(uint8_t samples);
         void writeRegister(uint8_t reg, uint8_t val);
         bool readRegister8(uint8_t reg, uint8_t *val);
         bool readMultipleRegisters(uint8_t reg, uint8_t count, uint8_t *buf);
+        void writeMultipleRegisters(uint8_t reg, uint8_t count, const uint8_t *buf);
+        static size_t appendName(char *buf, size_t size, size_t pos, const __FlashStringHelper *name);
+        static void rawToXyz(const uint8_t *rawData, xyzFloat *rawVal);
+        static void rawToXyz(const uint8_t *rawData, xyzInt16 *rawVal);
+        void updateScaling();
+        void updateHardwareOffsets();
+        void updateRangeFactor(adxl345_range range);
+        static bool isCacheable(uint8_t reg);
+        void cacheStore(uint8_t reg, uint8_t val);
         bool adxl345_lowRes;
 };
 
@@ -0,0 +1,83 @@
+/********************************************************************
+* Minimal stand-ins for the Arduino core, only compiled on hosts.
+*
+* Written by Wolfgang (Wolle) Ewald
+* https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+* https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+*
+*********************************************************************/
+
+#ifndef ARDUINO
+
+#include "ADXL345_host.h"
+#include <chrono>
+#include <thread>
+
+TwoWire Wire;
+SPIClass SPI;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static bool simulatedTime = false;
+static unsigned long simulatedMicros = 0;
+
+void setHostMicros(unsigned long us){
+    simulatedTime = true;
+    simulatedMicros = us;
+}
+
+void delay(unsigned long ms){
+    if(!simulatedTime){
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void delayMicroseconds(unsigned int us){
+    SPI.addDelay(us);
+    if(!simulatedTime){
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void digitalWrite(int pin, uint8_t val){
+    SPI.pinChanged(pin, val);
+}
+
+uint8_t SPIClass::transfer(uint8_t val){
+    transferCalls++;
+    bytes++;
+    busNanos += 8000000000ULL / clock;
+    return device ? device->exchange(val) : 0;
+}
+
+void SPIClass::transfer(void *buf, size_t count){
+    uint8_t *data = static_cast<uint8_t *>(buf);
+    transferCalls++;
+    bytes += count;
+    busNanos += count * 8000000000ULL / clock;
+    for(size_t i=0; i<count; i++){
+        data[i] = device ? device->exchange(data[i]) : 0;
+    }
+}
+
+void SPIClass::pinChanged(int pin, uint8_t val){
+    if(device && pin == devCsPin){
+        device->setSelected(val == LOW);
+    }
+}
+
+unsigned long millis(){
+    if(simulatedTime){
+        return simulatedMicros / 1000;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros(){
+    if(simulatedTime){
+        return simulatedMicros;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+#endif // ARDUINO
+
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Minimal stand-ins for the Arduino core used by the ADXL345_WE library.
+ * This header is only included if ARDUINO is not defined, i.e. when the
+ * library is compiled on a host (Linux, macOS, ...). TwoWire and SPIClass
+ * are inert there, so use an ADXL345_Bus implementation like ADXL345_SimBus
+ * to talk to a device.
+ *
+ * Written by Wolfgang (Wolle) Ewald
+ * https://wolles-elektronikkiste.de/adxl345-teil-1 (German)
+ * https://wolles-elektronikkiste.de/en/adxl345-the-universal-accelerometer-part-1 (English)
+ *
+ ******************************************************************************/
+
+#ifndef ADXL345_HOST_H_
+#define ADXL345_HOST_H_
+
+#ifndef ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+
+constexpr uint8_t HIGH      {1};
+constexpr uint8_t LOW       {0};
+constexpr uint8_t INPUT     {0};
+constexpr uint8_t OUTPUT    {1};
+constexpr uint8_t MSBFIRST  {1};
+constexpr uint8_t SPI_MODE3 {3};
+
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper *>(str))
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+class String
+{
+    public:
+        String() {}
+        String(const char *str) : s{str} {}
+        String(const __FlashStringHelper *str) : s{reinterpret_cast<const char *>(str)} {}
+        String & operator+=(const char *str) { s += str; return *this; }
+        String & operator+=(const String &str) { s += str.s; return *this; }
+        bool operator==(const char *str) const { return s == str; }
+        const char * c_str() const { return s.c_str(); }
+        unsigned int length() const { return s.length(); }
+    private:
+        std::string s;
+};
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+/* Switches millis() and micros() from the steady clock to a simulated time, which only changes
+   with the next call, e.g. for deterministic checks with ADXL345_SimBus. delay() and
+   delayMicroseconds() don't sleep then. */
+void setHostMicros(unsigned long us);
+inline void pinMode(int, uint8_t) {}
+void digitalWrite(int pin, uint8_t val);
+
+class TwoWire
+{
+    public:
+        void begin() {}
+        void beginTransmission(uint8_t) {}
+        size_t write(uint8_t) { return 1; }
+        uint8_t endTransmission(bool = true) { return 2; } // NACK, there is no device
+        uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+        int available() { return 0; }
+        int read() { return -1; }
+};
+
+class SPISettings
+{
+    public:
+        SPISettings() {}
+        SPISettings(unsigned long clk, uint8_t, uint8_t) : clock{clk} {}
+        unsigned long clock = 4000000;
+};
+
+/* A device model can be attached to SPIClass on host builds. It sees the CS pin changes 
+   (digitalWrite) and exchanges the bytes. */
+class ADXL345_HostSPIDevice
+{
+    public:
+        virtual void setSelected(bool selected) = 0;
+        virtual uint8_t exchange(uint8_t out) = 0;
+
+    protected:
+        ~ADXL345_HostSPIDevice() {}
+};
+
+/* Without a device, reads return 0. The bus time is modeled as 8 bits per clock for each
+   byte plus all delayMicroseconds() calls. */
+class SPIClass
+{
+    public:
+        void begin() {}
+        void beginTransaction(SPISettings settings) { clock = settings.clock; }
+        void endTransaction() {}
+        uint8_t transfer(uint8_t val);
+        void transfer(void *buf, size_t count);
+        void attachDevice(int csPin, ADXL345_HostSPIDevice *dev) { devCsPin = csPin; device = dev; }
+        void pinChanged(int pin, uint8_t val);
+        void addDelay(unsigned int us) { busNanos += 1000ULL * us; }
+
+        unsigned long getTransferCalls() { return transferCalls; }
+        unsigned long getBytes() { return bytes; }
+        unsigned long long getBusNanos() { return busNanos; }
+        void resetCounters() { transferCalls = 0; bytes = 0; busNanos = 0; }
+
+    private:
+        unsigned long clock = 4000000;
+        int devCsPin = -1;
+        ADXL345_HostSPIDevice *device = nullptr;
+        unsigned long transferCalls = 0;
+        unsigned long bytes = 0;
+        unsigned long long busNanos = 0;
+};
+
+extern TwoWire Wire;
+extern SPIClass SPI;
+
+#endif // ARDUINO
+
+#endif
+
@@ -0,0 +1,15 @@
+/* defines the structure xyzInt16, a compact x,y,z triple for raw values and results in 
+   integer units such as milli-g. Unlike xyzFloat (12 bytes) it takes 6 bytes per sample. */
+
+#ifndef XYZ_INT16_H_
+#define XYZ_INT16_H_
+#include <stdint.h>
+struct xyzInt16 {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+
+    xyzInt16() = default;
+    xyzInt16(int16_t const x, int16_t const y, int16_t const z) : x(x), y(y), z(z) {}
+};
+#endif